@@ -8,6 +8,8 @@
 #include <vector>
 #include <iosfwd>
 
+#include "Achilles/Binary.hh"
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wshadow"
 #include "yaml-cpp/yaml.h"
@@ -46,30 +48,56 @@ class AdaptiveMap {
         double upper_edge(size_t dim, size_t bin) const { return m_hist[dim*(m_bins+1) + bin + 1]; }
         double width(size_t dim, size_t bin) const { return upper_edge(dim, bin) - lower_edge(dim, bin); }
         size_t FindBin(size_t, double) const;
+        // Invert the map for one dimension, giving the uniform variable mapped to x
+        double Inverse(size_t, double) const;
 
         // Map information
         std::vector<double> Edges(size_t dim) const { 
-            return std::vector<double>(m_hist.begin() + static_cast<int>(dim*(m_bins+1)),
-                                       m_hist.begin() + static_cast<int>((dim+1)*(m_bins+1)));
+            return std::vector<double>(EdgesBegin(dim), EdgesEnd(dim));
         }
+        // Views of the edges of a dimension without copying
+        const double* EdgesBegin(size_t dim) const { return m_hist.data() + dim*(m_bins+1); }
+        const double* EdgesEnd(size_t dim) const { return EdgesBegin(dim) + m_bins + 1; }
         size_t Bins() const { return m_bins; }
         size_t Dims() const { return m_dims; }
+        bool IsUniform() const { return m_uniform; }
         // Used for testing purposes
-        std::vector<double> Hist() const { return m_hist; }
-        std::vector<double>& Hist() { return m_hist; }
+        const std::vector<double>& Hist() const { return m_hist; }
+        std::vector<double>& Hist() { m_uniform = false; return m_hist; }
 
         // Generate random numbers
-        double operator()(std::vector<double>&);
+        double operator()(std::vector<double>&) const;
         double GenerateWeight(const std::vector<double>&) const;
 
         // Update histograms
         void Adapt(const double&, const std::vector<double>&);
         void Split(AdaptiveMapSplit split = AdaptiveMapSplit::half);
             
+        friend BinaryConvert<AdaptiveMap>;
 
     private:
         std::vector<double> m_hist;
         size_t m_dims{}, m_bins{};
+        // The bins are equally spaced until the map is adapted, allowing a direct bin lookup
+        bool m_uniform{true};
+};
+
+template<>
+struct BinaryConvert<AdaptiveMap> {
+    static void Write(BinaryWriter &out, const AdaptiveMap &rhs) {
+        out.Write(rhs.m_dims);
+        out.Write(rhs.m_bins);
+        out.Write(rhs.m_uniform);
+        out.Write(rhs.m_hist);
+    }
+
+    static bool Read(BinaryReader &in, AdaptiveMap &rhs) {
+        in.Read(rhs.m_dims);
+        in.Read(rhs.m_bins);
+        in.Read(rhs.m_uniform);
+        in.Read(rhs.m_hist);
+        return rhs.m_hist.size() == rhs.m_dims*(rhs.m_bins + 1);
+    }
 };
 
 }
@@ -0,0 +1,33 @@
+#ifndef ALLOCATION_COUNTER_HH
+#define ALLOCATION_COUNTER_HH
+
+#include <cstddef>
+
+namespace achilles {
+
+/// The AllocationCounter class counts the heap allocations made by the current thread, to
+/// check that the event loop does not allocate once its storage has grown. The library never
+/// replaces the global allocation functions. An executable counting the allocations replaces
+/// them with functions calling Record, and calls Enable during its static initialization. This
+/// is done by the test suite when configured with ACHILLES_COUNT_ALLOCATIONS
+class AllocationCounter {
+    public:
+        /// Mark the allocations as counted, called by the replacement allocation functions
+        static void Enable() noexcept;
+
+        /// Whether the allocations are counted
+        ///@return bool: True if the executable replaced the global allocation functions
+        static bool Enabled() noexcept;
+
+        /// Count an allocation made by the current thread
+        static void Record() noexcept;
+
+        /// Number of allocations made by the current thread
+        ///@return size_t: The number of recorded allocations since the thread started, which
+        ///                is always zero if the allocations are not counted
+        static size_t Count() noexcept;
+};
+
+}
+
+#endif
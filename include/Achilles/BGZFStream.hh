@@ -0,0 +1,94 @@
+#ifndef BGZF_STREAM_HH
+#define BGZF_STREAM_HH
+
+#include <deque>
+#include <fstream>
+#include <future>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Achilles/BoundedQueue.hh"
+
+namespace achilles {
+
+/// The BGZFStreamBuf class compresses its output in the blocked gzip format (BGZF) of the
+/// SAM/BAM specification. The output is split into blocks of at most 64 kB, each compressed
+/// into an independent gzip member that records its compressed size in an extra field. The
+/// blocks are compressed in parallel on a pool of threads and written in order, so the file
+/// remains readable by any gzip decoder, while tools such as bgzip can index it for random
+/// access. Errors while compressing or writing set the bad bit of the stream, and are thrown
+/// when closing the file explicitly
+class BGZFStreamBuf : public std::streambuf {
+    public:
+        /// Open a file for compressed output
+        ///@param filename: The name of the file
+        ///@param nthreads: The number of compression threads
+        ///@param level: The zlib compression level
+        BGZFStreamBuf(const std::string&, size_t nthreads, int level=-1);
+        BGZFStreamBuf(const BGZFStreamBuf&) = delete;
+        BGZFStreamBuf& operator=(const BGZFStreamBuf&) = delete;
+        ~BGZFStreamBuf() override;
+
+        bool IsOpen() const { return m_file.is_open(); }
+
+        /// Write all pending blocks and the end-of-file marker, and close the file
+        void Close();
+
+        /// Compress a block into a BGZF member
+        ///@param data: The uncompressed data, at most block_size bytes
+        ///@param level: The zlib compression level
+        ///@return std::string: The compressed block
+        static std::string CompressBlock(const std::vector<char>&, int level=-1);
+
+        // Maximum uncompressed size of a block, such that the compressed block fits in 64 kB
+        static constexpr size_t block_size = 0xff00;
+        // Empty block marking the end of a BGZF file
+        static const std::string eof_marker;
+
+    protected:
+        int_type overflow(int_type) override;
+        std::streamsize xsputn(const char*, std::streamsize) override;
+        int sync() override;
+
+    private:
+        struct Job {
+            std::vector<char> data;
+            std::promise<std::string> result;
+        };
+
+        void SubmitBlock();
+        void WriteBlock();
+        void Compress();
+
+        std::ofstream m_file;
+        int m_level;
+        std::vector<char> m_block;
+        BoundedQueue<Job> m_jobs;
+        // Compressed blocks in the order they are written
+        std::deque<std::future<std::string>> m_pending;
+        size_t m_max_pending;
+        std::vector<std::thread> m_threads;
+};
+
+/// The BGZFStream class is an output stream writing a BGZF compressed file
+class BGZFStream : public std::ostream {
+    public:
+        BGZFStream(const std::string &filename, size_t nthreads, int level=-1)
+            : std::ostream(nullptr), m_buf{filename, nthreads, level} {
+            rdbuf(&m_buf);
+            if(!m_buf.IsOpen()) setstate(std::ios::failbit);
+        }
+
+        void close() {
+            m_buf.Close();
+        }
+
+    private:
+        BGZFStreamBuf m_buf;
+};
+
+}
+
+#endif
@@ -0,0 +1,192 @@
+#ifndef BINARY_HH
+#define BINARY_HH
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace achilles {
+
+class BinaryWriter;
+class BinaryReader;
+
+/// Specializations of BinaryConvert define the binary format of a type, in the same way as
+/// YAML::convert defines the YAML format. Each specialization provides:
+///   - static void Write(BinaryWriter&, const T&)
+///   - static bool Read(BinaryReader&, T&), returning false if the data does not match the type
+template<typename T>
+struct BinaryConvert;
+
+/// The binary format stores every value in 8 bytes in native byte order, i.e. integers as
+/// uint64_t and floating point numbers as double, with strings padded to a multiple of 8 bytes.
+/// All values are therefore aligned if the data starts at an aligned address, such that a
+/// memory mapped file can be read in place. Doubles are stored bit-exact.
+struct BinaryFormat {
+    // "ACHB" in the byte order of the machine writing the file
+    static constexpr uint32_t magic = 0x42484341;
+    // Version 2 adds the next event of the integrator
+    static constexpr uint32_t version = 2;
+};
+
+/// The BinaryWriter class writes values in the binary format to a stream, starting with a
+/// header containing the magic number and the version of the format
+class BinaryWriter {
+    public:
+        explicit BinaryWriter(std::ostream &out) : m_out{out} {
+            const uint32_t header[2] = {BinaryFormat::magic, BinaryFormat::version};
+            m_out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        }
+
+        template<typename T>
+        void Write(const T &value) {
+            if constexpr(std::is_integral_v<T> || std::is_enum_v<T>) {
+                WriteRaw(static_cast<uint64_t>(value));
+            } else if constexpr(std::is_floating_point_v<T>) {
+                WriteRaw(static_cast<double>(value));
+            } else {
+                BinaryConvert<T>::Write(*this, value);
+            }
+        }
+
+        void Write(const std::string &value) {
+            Write(value.size());
+            m_out.write(value.data(), static_cast<std::streamsize>(value.size()));
+            static constexpr char padding[8]{};
+            m_out.write(padding, static_cast<std::streamsize>((8 - value.size() % 8) % 8));
+        }
+
+        template<typename T>
+        void Write(const std::vector<T> &values) {
+            Write(values.size());
+            if constexpr(std::is_same_v<T, double>) {
+                m_out.write(reinterpret_cast<const char*>(values.data()),
+                            static_cast<std::streamsize>(values.size()*sizeof(double)));
+            } else {
+                for(const auto &value : values) Write(value);
+            }
+        }
+
+        bool Good() const { return m_out.good(); }
+
+    private:
+        template<typename T>
+        void WriteRaw(const T &value) {
+            static_assert(sizeof(T) == 8, "BinaryWriter: Values must be stored in 8 bytes");
+            m_out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        std::ostream &m_out;
+};
+
+/// The BinaryReader class reads values in the binary format from a block of memory, such as a
+/// file loaded with ReadFile or a memory mapped file. The memory must outlive the reader.
+/// Reading past the end of the data throws a std::runtime_error
+class BinaryReader {
+    public:
+        BinaryReader(const char *data, size_t size) : m_data{data}, m_size{size} {
+            uint32_t header[2]{};
+            if(m_size < sizeof(header))
+                throw std::runtime_error("BinaryReader: Data is too short for the header");
+            std::memcpy(header, m_data, sizeof(header));
+            m_pos = sizeof(header);
+
+            if(header[0] != BinaryFormat::magic)
+                throw std::runtime_error("BinaryReader: Invalid magic number or byte order");
+            if(header[1] == 0 || header[1] > BinaryFormat::version)
+                throw std::runtime_error("BinaryReader: Unsupported version "
+                                         + std::to_string(header[1]));
+            m_version = header[1];
+        }
+        explicit BinaryReader(const std::vector<char> &data) : BinaryReader(data.data(), data.size()) {}
+
+        /// Load a file into memory with a single read
+        ///@param filename: The file to read
+        ///@return std::vector<char>: The content of the file
+        static std::vector<char> ReadFile(const std::string &filename) {
+            std::ifstream in(filename, std::ios::binary | std::ios::ate);
+            if(!in) throw std::runtime_error("BinaryReader: Could not open " + filename);
+            std::vector<char> data(static_cast<size_t>(in.tellg()));
+            in.seekg(0);
+            in.read(data.data(), static_cast<std::streamsize>(data.size()));
+            return data;
+        }
+
+        template<typename T>
+        bool Read(T &value) {
+            if constexpr(std::is_same_v<T, bool>) {
+                value = ReadRaw<uint64_t>() != 0;
+            } else if constexpr(std::is_integral_v<T> || std::is_enum_v<T>) {
+                value = static_cast<T>(ReadRaw<uint64_t>());
+            } else if constexpr(std::is_floating_point_v<T>) {
+                value = static_cast<T>(ReadRaw<double>());
+            } else {
+                return BinaryConvert<T>::Read(*this, value);
+            }
+            return true;
+        }
+
+        bool Read(std::string &value) {
+            size_t size{};
+            Read(size);
+            // Check the size before padding it, which could overflow for corrupt data
+            if(size > Remaining())
+                throw std::runtime_error("BinaryReader: String exceeds the size of the data");
+            const char *begin = Advance(size + (8 - size % 8) % 8);
+            value.assign(begin, size);
+            return true;
+        }
+
+        template<typename T>
+        bool Read(std::vector<T> &values) {
+            size_t size{};
+            Read(size);
+            if(size > Remaining()/8)
+                throw std::runtime_error("BinaryReader: Vector exceeds the size of the data");
+            values.resize(size);
+            if constexpr(std::is_same_v<T, double>) {
+                std::memcpy(values.data(), Advance(size*sizeof(double)), size*sizeof(double));
+            } else {
+                for(auto &value : values)
+                    if(!Read(value)) return false;
+            }
+            return true;
+        }
+
+        template<typename T>
+        T Get() {
+            T value{};
+            if(!Read(value)) throw std::runtime_error("BinaryReader: Invalid data");
+            return value;
+        }
+
+        uint32_t Version() const { return m_version; }
+        size_t Remaining() const { return m_size - m_pos; }
+
+    private:
+        const char* Advance(size_t nbytes) {
+            if(nbytes > Remaining())
+                throw std::runtime_error("BinaryReader: Unexpected end of data");
+            const char *current = m_data + m_pos;
+            m_pos += nbytes;
+            return current;
+        }
+
+        template<typename T>
+        T ReadRaw() {
+            T value;
+            std::memcpy(&value, Advance(sizeof(T)), sizeof(T));
+            return value;
+        }
+
+        const char *m_data;
+        size_t m_size, m_pos{};
+        uint32_t m_version{};
+};
+
+}
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef BOUNDED_QUEUE_HH
+#define BOUNDED_QUEUE_HH
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+namespace achilles {
+
+/// The BoundedQueue class is a lock-free multi-producer multi-consumer queue of fixed capacity,
+/// following the array based queue of D. Vyukov. Each cell carries a sequence number telling
+/// producers and consumers whether it is free or filled for their position, such that pushing
+/// and popping only require a single compare-and-swap on the position in the uncontended case.
+/// The blocking Push and Pop back off by yielding and sleeping, and return false once the queue
+/// has been closed. The queue keeps statistics on its depth to monitor pipelines.
+template<typename T>
+class BoundedQueue {
+    public:
+        /// Create a queue
+        ///@param capacity: The minimum number of elements, rounded up to a power of two
+        explicit BoundedQueue(size_t capacity) {
+            size_t size = 2;
+            while(size < capacity) size *= 2;
+            m_mask = size - 1;
+            m_cells = std::make_unique<Cell[]>(size);
+            for(size_t i = 0; i < size; ++i)
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+        /// @name Non-blocking access
+        ///@{
+
+        /// Push an element if the queue is not full
+        ///@param value: The element, which is only moved from on success
+        ///@return bool: True if the element was added
+        bool TryPush(T &value) {
+            Cell *cell;
+            size_t pos = m_enqueue.load(std::memory_order_relaxed);
+            while(true) {
+                cell = &m_cells[pos & m_mask];
+                const size_t seq = cell -> sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+                if(diff == 0) {
+                    if(m_enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                } else if(diff < 0) {
+                    return false;
+                } else {
+                    pos = m_enqueue.load(std::memory_order_relaxed);
+                }
+            }
+            cell -> data = std::move(value);
+            cell -> sequence.store(pos + 1, std::memory_order_release);
+            RecordDepth();
+            return true;
+        }
+
+        /// Pop an element if the queue is not empty
+        ///@param value: Set to the element on success
+        ///@return bool: True if an element was removed
+        bool TryPop(T &value) {
+            Cell *cell;
+            size_t pos = m_dequeue.load(std::memory_order_relaxed);
+            while(true) {
+                cell = &m_cells[pos & m_mask];
+                const size_t seq = cell -> sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+                if(diff == 0) {
+                    if(m_dequeue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                } else if(diff < 0) {
+                    return false;
+                } else {
+                    pos = m_dequeue.load(std::memory_order_relaxed);
+                }
+            }
+            value = std::move(cell -> data);
+            cell -> sequence.store(pos + m_mask + 1, std::memory_order_release);
+            return true;
+        }
+        ///@}
+
+        /// @name Blocking access
+        ///@{
+
+        /// Push an element, waiting while the queue is full
+        ///@param value: The element to add
+        ///@return bool: False if the queue was closed before the element could be added
+        bool Push(T value) {
+            for(size_t attempt = 0; !m_closed.load(std::memory_order_acquire); ++attempt) {
+                if(TryPush(value)) return true;
+                Backoff(attempt);
+            }
+            return false;
+        }
+
+        /// Pop an element, waiting while the queue is empty
+        ///@param value: Set to the element on success
+        ///@return bool: False if the queue is closed and all elements have been removed
+        bool Pop(T &value) {
+            for(size_t attempt = 0;; ++attempt) {
+                if(TryPop(value)) return true;
+                if(m_closed.load(std::memory_order_acquire)) return TryPop(value);
+                Backoff(attempt);
+            }
+        }
+
+        /// Wake up all waiting threads. Remaining elements can still be popped
+        void Close() { m_closed.store(true, std::memory_order_release); }
+        bool Closed() const { return m_closed.load(std::memory_order_acquire); }
+        ///@}
+
+        /// @name Statistics
+        ///@{
+
+        size_t Capacity() const { return m_mask + 1; }
+        /// The approximate number of elements, exact when no other thread accesses the queue
+        size_t Size() const {
+            const size_t enqueue = m_enqueue.load(std::memory_order_relaxed);
+            const size_t dequeue = m_dequeue.load(std::memory_order_relaxed);
+            return enqueue > dequeue ? enqueue - dequeue : 0;
+        }
+        size_t Pushed() const { return m_pushed.load(std::memory_order_relaxed); }
+        size_t MaxDepth() const { return m_max_depth.load(std::memory_order_relaxed); }
+        /// The average number of elements in the queue seen by pushed elements
+        double MeanDepth() const {
+            const size_t pushed = Pushed();
+            return pushed == 0 ? 0 : static_cast<double>(m_sum_depth.load(std::memory_order_relaxed))
+                                     / static_cast<double>(pushed);
+        }
+        ///@}
+
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence{};
+            T data{};
+        };
+
+        void RecordDepth() {
+            const size_t depth = Size();
+            m_pushed.fetch_add(1, std::memory_order_relaxed);
+            m_sum_depth.fetch_add(depth, std::memory_order_relaxed);
+            size_t max_depth = m_max_depth.load(std::memory_order_relaxed);
+            while(depth > max_depth
+                  && !m_max_depth.compare_exchange_weak(max_depth, depth, std::memory_order_relaxed)) {}
+        }
+
+        static void Backoff(size_t attempt) {
+            static constexpr size_t spins = 64, yields = 128;
+            if(attempt < spins) return;
+            if(attempt < yields) {
+                std::this_thread::yield();
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+
+        std::unique_ptr<Cell[]> m_cells;
+        size_t m_mask{};
+        alignas(64) std::atomic<size_t> m_enqueue{};
+        alignas(64) std::atomic<size_t> m_dequeue{};
+        alignas(64) std::atomic<bool> m_closed{false};
+        std::atomic<size_t> m_pushed{}, m_sum_depth{}, m_max_depth{};
+};
+
+}
+
+#endif
@@ -11,6 +11,7 @@
 #include "Achilles/Random.hh"
 #include "Achilles/Interpolation.hh"
 #include "Achilles/Interactions.hh"
+#include "Achilles/SpatialGrid.hh"
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wshadow"
@@ -32,6 +33,7 @@ using InteractionDistances = std::vector<std::pair<std::size_t, double>>;
 /// propagating nucleon.
 class Cascade {
     static constexpr int cMaxSteps = 100000;
+    static constexpr double cSearchRadius = 3.0;
     public:
         // Probability Enums
         enum ProbabilityType {
@@ -47,6 +49,12 @@ class Cascade {
             Relativistic
         };
 
+        // Search for interaction candidates Enums
+        enum SearchMode {
+            BruteForce,
+            Grid
+        };
+
         /// @name Constructor and Destructor
         ///@{
 
@@ -102,9 +110,42 @@ class Cascade {
         ///@return double: default step size
         double StepSize() const { return distance; }
 
+        /// Get the mode used to search for interaction candidates
+        ///@return SearchMode: The search mode
+        SearchMode Search() const { return m_search; }
+
+        /// Get the maximum impact parameter considered in the Grid search mode
+        ///@return double: The search radius in fm
+        double SearchRadius() const { return m_searchRadius; }
+        ///@}
+
+        /// @name Setters
+        ///@{
+
+        /// Set how interaction candidates are found. The BruteForce mode tests every background
+        /// nucleon in each step. The Grid mode only tests nucleons from a spatial grid within
+        /// the search radius of the path of the propagating particle. The Gaussian and Pion
+        /// probabilities have tails beyond any radius, and the Cylinder probability extends to
+        /// sqrt(sigma/pi), so the Grid mode changes the results unless the radius covers them.
+        ///@param mode: The search mode to use
+        ///@param radius: The maximum impact parameter in fm used for the Grid mode
+        void SetSearch(const SearchMode &mode, double radius=cSearchRadius) {
+            m_search = mode;
+            m_searchRadius = radius;
+        }
+        ///@}
+
         /// @name Functions
         ///@{
 
+        /// Find the background nucleons a particle can interact with in its next step of
+        /// length StepSize, using the current search mode. The particles are not modified
+        ///@param particles: The particles in the nucleus
+        ///@param idx: The index of the propagating particle
+        ///@return InteractionDistances: The candidates and their squared impact parameters,
+        ///                              sorted by impact parameter
+        InteractionDistances InteractionCandidates(Particles particles, std::size_t idx);
+
         /// Give a random particle in the nucleus a kick. The kick is defined by a input
         /// four vector. To determine whether a proton or a neutron is kicked, the cross-section
         /// for protons and neutrons needs to be supplied.
@@ -158,7 +199,8 @@ class Cascade {
         void AdaptiveStep(const Particles&, const double&) noexcept;
         bool BetweenPlanes(const ThreeVector&, const ThreeVector&, const ThreeVector&, double) const noexcept;
         const ThreeVector Project(const ThreeVector&, const ThreeVector&, const ThreeVector&) const noexcept;
-        const InteractionDistances AllowedInteractions(Particles&, const std::size_t&) const noexcept;
+        const InteractionDistances AllowedInteractions(Particles&, const std::size_t&) noexcept;
+        void BuildGrid(const Particles&);
         double GetXSec(const Particle&, const Particle&) const;
         std::size_t Interacted(const Particles&, const Particle&,
                 const InteractionDistances&) noexcept;
@@ -179,6 +221,10 @@ class Cascade {
         bool m_potential_prop;
         std::map<size_t, SymplecticIntegrator> integrators;
         std::string m_probability_name;
+        SearchMode m_search{SearchMode::BruteForce};
+        double m_searchRadius{cSearchRadius};
+        SpatialGrid m_grid;
+        std::vector<std::size_t> m_candidates;
 };
 
 }
@@ -193,6 +239,13 @@ struct convert<achilles::Cascade> {
         auto potentialProp = node["PotentialProp"].as<bool>();
         auto distance = node["Step"].as<double>();
         cascade = achilles::Cascade(std::move(interaction), probType, mediumType, potentialProp, distance);
+        if(node["Search"]) {
+            auto search = node["Search"].as<achilles::Cascade::SearchMode>();
+            if(node["SearchRadius"])
+                cascade.SetSearch(search, node["SearchRadius"].as<double>());
+            else
+                cascade.SetSearch(search);
+        }
         return true;
     }
 };
@@ -212,6 +265,19 @@ struct convert<achilles::Cascade::ProbabilityType> {
     }
 };
 
+template<>
+struct convert<achilles::Cascade::SearchMode> {
+    static bool decode(const Node &node, achilles::Cascade::SearchMode &type) {
+        if(node.as<std::string>() == "BruteForce")
+            type = achilles::Cascade::SearchMode::BruteForce;
+        else if(node.as<std::string>() == "Grid")
+            type = achilles::Cascade::SearchMode::Grid;
+        else
+            return false;
+        return true;
+    }
+};
+
 template<>
 struct convert<achilles::Cascade::InMedium> {
     static bool decode(const Node &node, achilles::Cascade::InMedium &type) {
@@ -7,6 +7,7 @@
 namespace achilles {
 
 class Particle;
+class ParticleView;
 class CutCollection;
 
 class CombinedOneParticleCut {
@@ -48,6 +49,7 @@ class CombinedTwoParticleCut {
 
 class CutCollection {
     public:
+        bool EvaluateCuts(const ParticleView&);
         bool EvaluateCuts(const std::vector<Particle>&);
         double CutEfficiency() const;
         bool AddCut(const std::set<PID>&, std::unique_ptr<OneParticleCut>);
@@ -5,6 +5,8 @@
 #include <string>
 #include <vector>
 
+#include "Achilles/Random.hh"
+
 namespace achilles {
 
 class Particle;
@@ -37,17 +39,21 @@ class Density {
         Density& operator=(Density&&) = default;
         virtual ~Density() = default;
         virtual std::vector<Particle> GetConfiguration() = 0;
+        // Overwrite the particles with a new configuration, reusing their storage
+        virtual void FillConfiguration(std::vector<Particle> &particles) { particles = GetConfiguration(); }
 };
 
 class DensityConfiguration : public Density {
     public:
         DensityConfiguration(const std::string&);
         std::vector<Particle> GetConfiguration() override;
+        void FillConfiguration(std::vector<Particle>&) override;
 
     private:
         size_t m_nconfigs, m_nnucleons;
         double m_maxWgt, m_minWgt;
         std::vector<Configuration> m_configurations;
+        AliasTable m_sampler;
 };
 
 }
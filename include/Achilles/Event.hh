@@ -11,6 +11,7 @@
 #include "Achilles/NuclearRemnant.hh"
 #include "Achilles/ProcessInfo.hh"
 #include "Achilles/EventHistory.hh"
+#include "Achilles/ParticleView.hh"
 
 namespace achilles {
 
@@ -40,15 +41,35 @@ class Event {
 
     public:
         Event(double vWgt = 0) : m_vWgt{vWgt} {}
+        /// Create an empty event for a nucleus, to be filled by Reset
+        explicit Event(std::shared_ptr<Nucleus> nuc) : m_nuc{std::move(nuc)} {}
         Event(std::shared_ptr<Nucleus>, 
               std::vector<FourVector>, double);
         MOCK ~Event() = default;
 
+        /// Start a new event with the same nucleus, which generates a new configuration. The
+        /// storage of the particles, weights, and history is kept, such that reusing an event
+        /// does not allocate once it has grown to the size of a typical event
+        ///@param mom: The momenta of the phase space point
+        ///@param vWgt: The weight of the phase space point
+        void Reset(const std::vector<FourVector>&, double);
+
         void SetHardScatteringType(HardScatteringType type) { m_type = type; }
         MOCK void InitializeLeptons(const Process_Info&);
         MOCK void InitializeHadrons(const Process_Info&);
         void Finalize();
 
+        /// Copy the event with its nucleons moved into a nucleus owned by the copy, such that
+        /// the copy is not changed by later events generated with the same nucleus
+        ///@return Event: The independent copy
+        Event Detach() const;
+
+        /// Overwrite the event with an independent copy of another, as made by Detach. The
+        /// nucleus and the storage of this event are reused, such that copying into the same
+        /// event repeatedly does not allocate once it has grown to the size of a typical event
+        ///@param other: The event to copy
+        void CopyFrom(const Event&);
+
         MOCK const NuclearRemnant &Remnant() const { return m_remnant; }
 
         MOCK const vMomentum &Momentum() const { return m_mom; }
@@ -73,6 +94,11 @@ class Event {
         double& Flux() { return flux; }
 
         MOCK vParticles Particles() const;
+        /// View the hadrons followed by the leptons without copying them. The views are
+        /// invalidated when particles are added to or removed from the event
+        ParticleView ParticlesView() const { return {Hadrons(), Leptons()}; }
+        FilteredParticleView<IsFinalState> FinalParticlesView() const { return ParticlesView().Final(); }
+        FilteredParticleView<HasPID> ParticlesView(PID pid) const { return ParticlesView().WithPID(pid); }
         MOCK const vParticles& Hadrons() const;
         MOCK vParticles& Hadrons();
         MOCK const vParticles& Leptons() const { return m_leptons; }
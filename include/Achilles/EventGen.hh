@@ -11,6 +11,8 @@
 #include "Achilles/Unweighter.hh"
 
 #include <memory>
+#include <mutex>
+#include <string_view>
 #include <vector>
 
 namespace YAML {
@@ -34,20 +36,68 @@ class SherpaInterface;
 class EventGen {
     public:
         EventGen(const std::string&, std::vector<std::string>);
+        ~EventGen();
         void Initialize();
         void GenerateEvents();
 
+        // Options changing the trained integrator, which invalidate a saved checkpoint
+        static const std::vector<std::string_view> &CheckpointOptions();
+
     private:
+        // Create a worker for multi-threaded event generation from a fully initialized generator
+        EventGen(const EventGen&, size_t);
+        void SetupPhysics(std::vector<std::string>);
+        // Create a nucleus with its own potential, sharing the density of the existing nucleus
+        std::shared_ptr<Nucleus> MakeNucleus() const;
+        void GenerateEventsThreaded();
+        // Split the generation across workers, and combine their results in a fixed order
+        std::vector<std::unique_ptr<EventGen>> MakeWorkers() const;
+        void RunWorkers(std::vector<std::unique_ptr<EventGen>>&) const;
+        void MergeWorkers(const std::vector<std::unique_ptr<EventGen>>&);
+        // Generate events in stages connected by queues: the workers evaluate the hard
+        // scattering and unweight, a pool of threads runs the cascade, and one thread writes
+        struct Pipeline;
+        void GenerateEventsPipelined();
+        void PrintPipeline() const;
+        // Restore or save the trained integrator and unweighter, keyed by the hash of the run card
+        bool LoadCheckpoint(const std::string&, uint64_t);
+        void SaveCheckpoint(const std::string&, uint64_t) const;
+        bool LoadBinaryCheckpoint(const std::string&, uint64_t);
+        void SaveBinaryCheckpoint(const std::string&, uint64_t) const;
+
         bool runCascade{false}, outputEvents{false}, doHardCuts{false};
         bool runDecays{true};
         bool doRotate{false};
+        // Write events with zero weight instead of only counting them as trials
+        bool writeRejected{false};
+        unsigned int m_seed{};
+        size_t m_nthreads{1}, m_worker{}, m_nevents{};
+        // Number of events reaching the unweighting and of cascade evaluations
+        size_t m_nunweight{}, m_ncascade{};
+        // Number of rejected events not yet passed to the writer
+        size_t m_ntrials{};
+        // Number of events set up by the worker, and the heap allocations made doing so when
+        // they are counted
+        size_t m_nreset{}, m_nreset_allocs{};
+        // Threads of the cascade stage and capacity of the queues in the pipelined mode
+        size_t m_cascade_threads{}, m_queue_size{};
+        std::shared_ptr<Pipeline> m_pipeline;
+        // Evaluate the integrand for a phase space point. In the pipeline, accepted events are
+        // handed over to the cascade stage
         double GenerateEvent(const std::vector<FourVector>&, const double&);
+        double EvaluateEvent(const std::vector<FourVector>&, const double&);
+        // Run the cascade for an accepted event and build its history
+        void FinishEvent(Event&, Cascade*) const;
+        void WriteEvent(const Event&);
+        void RejectEvent(const Event&);
         bool MakeCuts(Event&);
         // bool MakeEventCuts(Event&);
-        void Rotate(Event&);
+        void Rotate(Event&) const;
 
         std::shared_ptr<Beam> beam;
         std::shared_ptr<Nucleus> nucleus;
+        // Storage of the event being generated, reused across events
+        std::unique_ptr<Event> m_event;
         std::shared_ptr<Cascade> cascade;
         std::shared_ptr<HardScattering> scattering;
         CutCollection hard_cuts{};
@@ -59,6 +109,7 @@ class EventGen {
         std::ofstream outputfile;
 
         std::shared_ptr<EventWriter> writer;
+        std::shared_ptr<std::mutex> writer_mutex;
         std::unique_ptr<Unweighter> unweighter;
 #ifdef ENABLE_BSM
         SherpaInterface *p_sherpa;
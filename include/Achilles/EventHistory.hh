@@ -1,7 +1,13 @@
 #ifndef EVENT_HISTORY_HH
 #define EVENT_HISTORY_HH
 
-#include <memory>
+#include <algorithm>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "Achilles/Particle.hh"
 #include "Achilles/ParticleInfo.hh"
@@ -20,6 +26,49 @@ struct compare_momentum {
     double eps;
 };
 
+/// The IndexedParticles class is a non-owning list of the particles of a vertex, stored as
+/// indices into a particle table. Table is either std::vector<Particle> or its const version
+template<typename Table>
+class IndexedParticles {
+    public:
+        using reference = decltype(std::declval<Table&>()[0]);
+
+        class iterator {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = Particle;
+                using difference_type = std::ptrdiff_t;
+                using reference = typename IndexedParticles::reference;
+                using pointer = std::remove_reference_t<reference>*;
+
+                iterator(Table *table, const size_t *id) : m_table{table}, m_id{id} {}
+                reference operator*() const { return (*m_table)[*m_id]; }
+                pointer operator->() const { return &(*m_table)[*m_id]; }
+                iterator& operator++() { ++m_id; return *this; }
+                iterator operator++(int) { auto tmp = *this; ++m_id; return tmp; }
+                bool operator==(const iterator &other) const { return m_id == other.m_id; }
+                bool operator!=(const iterator &other) const { return m_id != other.m_id; }
+
+            private:
+                Table *m_table;
+                const size_t *m_id;
+        };
+
+        IndexedParticles(Table &table, const std::vector<size_t> &ids) : m_table{&table}, m_ids{&ids} {}
+
+        size_t size() const { return m_ids -> size(); }
+        bool empty() const { return m_ids -> empty(); }
+        reference operator[](size_t idx) const { return (*m_table)[(*m_ids)[idx]]; }
+        iterator begin() const { return {m_table, m_ids -> data()}; }
+        iterator end() const { return {m_table, m_ids -> data() + m_ids -> size()}; }
+
+    private:
+        Table *m_table;
+        const std::vector<size_t> *m_ids;
+};
+
+class EventHistory;
+
 class EventHistoryNode {
     public:
         enum class StatusCode : int {
@@ -31,12 +80,25 @@ class EventHistoryNode {
             decay = 4,
             shower = 5,
         };
+        using ParticleList = IndexedParticles<std::vector<Particle>>;
+        using ConstParticleList = IndexedParticles<const std::vector<Particle>>;
 
         EventHistoryNode(size_t idx, StatusCode status = StatusCode::cascade) : m_idx{idx}, m_status{status} {}
         EventHistoryNode(size_t idx, ThreeVector position, StatusCode status = StatusCode::cascade) 
             : m_idx{idx}, m_position{position}, m_status{status} {}
-        void AddIncoming(const Particle &part) { m_particles_in.push_back(part); }
-        void AddOutgoing(const Particle &part) { m_particles_out.push_back(part); }
+        EventHistoryNode(const EventHistoryNode&);
+        EventHistoryNode& operator=(const EventHistoryNode&);
+
+        // Add particles to a vertex outside of an EventHistory. The vertices of a history are
+        // filled through the history, which shares the particles between the vertices
+        void AddIncoming(const Particle &part) {
+            m_table -> push_back(part);
+            m_ids_in.push_back(m_table -> size() - 1);
+        }
+        void AddOutgoing(const Particle &part) {
+            m_table -> push_back(part);
+            m_ids_out.push_back(m_table -> size() - 1);
+        }
 
         // Status functions
         StatusCode& Status() { return m_status; }
@@ -49,22 +111,44 @@ class EventHistoryNode {
 
         // Graph accessors
         size_t Index() const { return m_idx; }
-        bool HasIncoming(const Particle &part) { 
-            return std::find_if(m_particles_in.begin(), m_particles_in.end(),
-                                compare_momentum(part)) != m_particles_in.end();
+        bool HasIncoming(const Particle &part) const { 
+            auto particles = ParticlesIn();
+            return std::find_if(particles.begin(), particles.end(), compare_momentum(part)) != particles.end();
         }
-        bool HasOutgoing(const Particle &part) {
-            return std::find_if(m_particles_out.begin(), m_particles_out.end(),
-                                compare_momentum(part)) != m_particles_out.end();
+        bool HasOutgoing(const Particle &part) const {
+            auto particles = ParticlesOut();
+            return std::find_if(particles.begin(), particles.end(), compare_momentum(part)) != particles.end();
         }
-        const std::vector<Particle>& ParticlesIn() const { return m_particles_in; }
-        std::vector<Particle>& ParticlesIn() { return m_particles_in; }
-        const std::vector<Particle>& ParticlesOut() const { return m_particles_out; }
-        std::vector<Particle>& ParticlesOut() { return m_particles_out; }
+        ConstParticleList ParticlesIn() const { return {*m_table, m_ids_in}; }
+        ParticleList ParticlesIn() { return {*m_table, m_ids_in}; }
+        ConstParticleList ParticlesOut() const { return {*m_table, m_ids_out}; }
+        ParticleList ParticlesOut() { return {*m_table, m_ids_out}; }
         const ThreeVector& Position() const { return m_position; }
 
+        // Indices of the particles in the EventHistory, parallel to the particle lists
+        const std::vector<size_t>& IdsIn() const { return m_ids_in; }
+        const std::vector<size_t>& IdsOut() const { return m_ids_out; }
+        static constexpr size_t no_id = std::numeric_limits<size_t>::max();
+
+        friend EventHistory;
+
     private:
-        std::vector<Particle> m_particles_in{}, m_particles_out{};
+        EventHistoryNode(std::vector<Particle> *table, size_t idx, ThreeVector position, StatusCode status)
+            : m_table{table}, m_idx{idx}, m_position{position}, m_status{status} {}
+        // Reuse the node, keeping the capacity of the particle lists
+        void Reset(size_t idx, ThreeVector position, StatusCode status) {
+            m_ids_in.clear();
+            m_ids_out.clear();
+            m_idx = idx;
+            m_position = position;
+            m_status = status;
+        }
+        bool OwnsParticles() const { return m_table == &m_local; }
+
+        // Particles of a vertex outside of an EventHistory
+        std::vector<Particle> m_local{};
+        std::vector<Particle> *m_table{&m_local};
+        std::vector<size_t> m_ids_in{}, m_ids_out{};
         size_t m_idx;
         ThreeVector m_position{};
         StatusCode m_status;
@@ -97,17 +181,56 @@ class HistoryVisitor {
         virtual void visit(EventHistoryNode*) = 0;
 };
 
+/// The EventHistory class records the vertices of an event. The vertices are kept in a pool
+/// that is reset, not freed, between events, such that recording the full cascade does not
+/// allocate once the pool has grown to the size of a typical event. The particles are stored
+/// once in a table shared by the vertices, which refer to them by index, and each particle
+/// records the vertices it enters and leaves to navigate the graph without searching.
+/// Particles added with AddParticle keep their own index, while particles passed by value to
+/// the vertices are linked to an existing particle with the same id, status and momentum
 class EventHistory {
     public:
         using StatusCode = EventHistoryNode::StatusCode;
         EventHistory() = default;
+        // Copies own a copy of every vertex
+        EventHistory(const EventHistory&);
+        EventHistory(EventHistory&&) noexcept;
+        EventHistory& operator=(const EventHistory&);
+        EventHistory& operator=(EventHistory&&) noexcept;
+        ~EventHistory() = default;
+
+        /// Remove all vertices and particles, keeping the storage for the next event
+        void Reset();
+
         void AddVertex(ThreeVector position, const std::vector<Particle> &in = {},
                        const std::vector<Particle> &out = {}, StatusCode status = StatusCode::cascade);
+
+        /// Add a particle to the history without linking it to a vertex. The particle is never
+        /// merged with another one, even if they have the same momentum
+        ///@param part: The particle to add
+        ///@return size_t: The index of the particle, to be passed to AddVertexByIds
+        size_t AddParticle(const Particle &part);
+
+        /// Add a vertex with particles referred to by the indices returned from AddParticle
+        ///@param position: The position of the vertex
+        ///@param in: The indices of the incoming particles
+        ///@param out: The indices of the outgoing particles
+        ///@param status: The status of the vertex
+        void AddVertexByIds(ThreeVector position, const std::vector<size_t> &in,
+                            const std::vector<size_t> &out, StatusCode status = StatusCode::cascade);
         void AddParticleIn(size_t idx, const Particle &part);
         void AddParticleOut(size_t idx, const Particle &part);
         void InsertShowerVert(ThreeVector position, const Particle &org, const Particle &in,
                               const Particle &out_org, const std::vector<Particle> &other);
 
+        /// Replace an outgoing particle of a vertex, such as to link it to the vertex the new
+        /// particle enters
+        ///@param node: The vertex to update
+        ///@param org: The particle to replace, compared by momentum and id
+        ///@param part: The new particle
+        ///@return bool: Whether the particle was found
+        bool ReplaceOutgoing(EventHistoryNode *node, const Particle &org, const Particle &part);
+
         // Accessors
         EventHistoryNode* Node(size_t idx) const;
         std::vector<EventHistoryNode*> Children(size_t idx) const;
@@ -124,13 +247,38 @@ class EventHistory {
         void WalkHistory(HistoryVisitor&) const;
 
         // Information
-        size_t size() { return m_history.size(); }
+        size_t size() const { return m_nnodes; }
+
+        /// The distinct particles of the history. A particle leaving one vertex and entering
+        /// another has a single entry, whose index is stored in the IdsIn and IdsOut of the
+        /// vertices, such that writers can map the particles without comparing momenta
+        const std::vector<Particle>& Particles() const { return m_particles; }
+        size_t NParticles() const { return m_particles.size(); }
 
     private:
         EventHistoryNode* FindNode(bool, const Particle&) const;
         EventHistoryNode* GetUniqueNode(StatusCode) const;
-        std::vector<std::unique_ptr<EventHistoryNode>> m_history{};
-        size_t cur_idx{};
+        EventHistoryNode& NewNode(ThreeVector, StatusCode);
+        size_t ParticleID(const Particle&);
+        static size_t HashParticle(const Particle&);
+        void InsertLookup(size_t);
+        void Link(EventHistoryNode&, bool, size_t);
+        void Relink(EventHistoryNode&, bool, size_t, size_t);
+        void Rebind();
+
+        static constexpr size_t no_node = std::numeric_limits<size_t>::max();
+
+        // The deque keeps the vertices in place as the pool grows. Only the first m_nnodes
+        // vertices belong to the current event
+        mutable std::deque<EventHistoryNode> m_nodes{};
+        size_t m_nnodes{};
+        std::vector<Particle> m_particles{};
+        // First vertex each particle enters and leaves, or no_node
+        std::vector<size_t> m_node_in{}, m_node_out{};
+        // Open addressing table of the particles linked by value, storing index + 1 and 0 for
+        // empty slots. It is cleared, not freed, between events
+        std::vector<size_t> m_lookup{};
+        size_t m_nlookup{};
 };
 
 struct PrintVisitor : HistoryVisitor {
@@ -1,16 +1,27 @@
 #ifndef EVENT_WRITER_HH
 #define EVENT_WRITER_HH
 
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <ostream>
 #include <fstream>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "Achilles/BoundedQueue.hh"
+#include "Achilles/Statistics.hh"
+#include "fmt/format.h"
+
 #if GZIP
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wshadow"
 #include "gzstream/gzstream.h"
 #pragma GCC diagnostic pop
+#include "Achilles/BGZFStream.hh"
 #endif
 
 namespace achilles {
@@ -28,40 +39,107 @@ class EventWriter {
 
         virtual void WriteHeader(const std::string&) = 0;
         virtual void Write(const Event&) = 0;
+
+        // Account for rejected events that are not written, such that the cross section
+        // is normalized to the total number of trials
+        virtual void AddTrials(size_t) {}
+        // Write the final cross section after all events have been generated
+        virtual void WriteFooter() {}
+        // Wait until all events have been written
+        virtual void Flush() {}
 };
 
+/// The AsyncWriter class wraps another writer and writes the events on a background thread,
+/// such that the generation does not wait for formatting, compression and disk I/O. Events are
+/// copied into a ring buffer, and writing waits while the buffer is full. The copies are returned
+/// to a pool once written, and reused for later events. All calls are passed
+/// on in order, so the output is identical to that of the wrapped writer. Errors on the
+/// background thread are rethrown by the next call, and all events are written on destruction
+class AsyncWriter : public EventWriter {
+    public:
+        AsyncWriter(std::unique_ptr<EventWriter>, size_t capacity=1024);
+        AsyncWriter(const AsyncWriter&) = delete;
+        AsyncWriter(AsyncWriter&&) = delete;
+        AsyncWriter& operator=(const AsyncWriter&) = delete;
+        AsyncWriter& operator=(AsyncWriter&&) = delete;
+        ~AsyncWriter() override;
+
+        void WriteHeader(const std::string&) override;
+        void Write(const Event&) override;
+        void AddTrials(size_t) override;
+        void WriteFooter() override;
+        void Flush() override;
+
+    private:
+        struct Item {
+            enum class Type { Header, Event, Trials, Footer };
+            Type type{Type::Event};
+            std::unique_ptr<Event> event;
+            std::string header;
+            size_t ntrials{};
+        };
+
+        void Push(Item);
+        void Drain();
+        void RethrowError();
+        // Wake up the threads waiting in Flush, if any
+        void NotifyFlush();
+
+        std::unique_ptr<EventWriter> m_writer;
+        BoundedQueue<Item> m_queue;
+        // Written events, reused to copy later events into. It holds the events in the queue,
+        // and the one being copied and written
+        BoundedQueue<std::unique_ptr<Event>> m_events;
+        std::atomic<size_t> m_pushed{}, m_written{};
+        std::atomic<bool> m_failed{false};
+        std::exception_ptr m_error;
+        // Threads in Flush wait for the written events without spinning
+        std::atomic<size_t> m_flushing{};
+        std::mutex m_flush_mutex;
+        std::condition_variable m_flushed;
+        std::thread m_thread;
+};
+
+/// The AchillesWriter class writes the events in a human readable format. The events are
+/// formatted into a buffer, which is passed on to the stream in blocks of at least
+/// buffer_size bytes when writing to a file, and after each event otherwise
 class AchillesWriter : public EventWriter {
     public:
-        AchillesWriter(const std::string&, bool=true);
+        /// Open a file for output
+        ///@param filename: The name of the file
+        ///@param zip: Whether to compress the file
+        ///@param threads: The number of threads compressing the file in blocks, or zero to use
+        ///                a single gzip stream
+        AchillesWriter(const std::string&, bool=true, size_t=0);
         AchillesWriter(std::ostream *out) : m_out{out} {}
-        AchillesWriter(const AchillesWriter&) = default;
-        AchillesWriter(AchillesWriter&&) = default;
-        AchillesWriter& operator=(const AchillesWriter&) = default;
-        AchillesWriter& operator=(AchillesWriter&&) = default;
-        ~AchillesWriter() override {
-            if(toFile) {
-#ifdef GZIP
-                if(zipped) {
-                    dynamic_cast<ogzstream*>(m_out) -> close();
-                } else {
-                    dynamic_cast<std::ofstream*>(m_out) -> close();
-                }
-#else
-                dynamic_cast<std::ofstream*>(m_out) -> close();
-#endif
-                delete m_out;
-            }
-            m_out = nullptr;
-        }
+        AchillesWriter(const AchillesWriter&) = delete;
+        AchillesWriter(AchillesWriter&&) = delete;
+        AchillesWriter& operator=(const AchillesWriter&) = delete;
+        AchillesWriter& operator=(AchillesWriter&&) = delete;
+        /// Write the remaining events and close the file. Errors while closing the file are
+        /// logged, since they can not be thrown from the destructor
+        ~AchillesWriter() override;
 
         void WriteHeader(const std::string&) override;
         void Write(const Event&) override;
+        void AddTrials(size_t) override;
+        void WriteFooter() override;
+        void Flush() override {
+            WriteBuffer();
+            m_out -> flush();
+        }
+
+        static constexpr size_t buffer_size = 1 << 16;
 
     private:
+        void WriteBuffer();
+
         bool toFile{false};
         bool zipped{true};
         size_t nEvents{0};
+        StatsData results;
         std::ostream *m_out; 
+        fmt::memory_buffer m_buffer;
 };
 
 }
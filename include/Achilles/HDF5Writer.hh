@@ -0,0 +1,79 @@
+#ifndef HDF5_WRITER_HH
+#define HDF5_WRITER_HH
+
+#include <string>
+#include <vector>
+
+#include "Achilles/EventWriter.hh"
+#include "Achilles/Statistics.hh"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wshadow"
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#include "highfive/H5File.hpp"
+#pragma GCC diagnostic pop
+
+namespace achilles {
+
+/// The HDF5Writer class writes the events into columns of an HDF5 file, such that analyses
+/// can read the quantities they need without parsing the whole event record. The file has
+/// the layout:
+///
+///     /events/weight, /events/flux, /events/remnant : One entry per event
+///     /events/offset : Index of the first particle of each event in the particle columns.
+///                      The particles of the last event extend to the end of the columns
+///     /particles/pid, /particles/status : One entry per particle
+///     /particles/E, px, py, pz, x, y, z : Momenta and positions of the particles
+///
+/// The run card, the version, and the cross section are stored as attributes of the root
+/// group. The columns are extendable chunked datasets, optionally compressed, and the events
+/// are buffered in memory until a full chunk can be written
+class HDF5Writer : public EventWriter {
+    public:
+        /// Open a file for output
+        ///@param filename: The name of the file, which is overwritten if it exists
+        ///@param zip: Whether to compress the columns
+        ///@param chunk_size: The number of entries per chunk of the columns, raised to one if zero
+        HDF5Writer(const std::string&, bool=true, size_t=65536);
+        HDF5Writer(const HDF5Writer&) = delete;
+        HDF5Writer& operator=(const HDF5Writer&) = delete;
+        ~HDF5Writer() override;
+
+        void WriteHeader(const std::string&) override;
+        void Write(const Event&) override;
+        void AddTrials(size_t) override;
+        void WriteFooter() override;
+        void Flush() override;
+
+    private:
+        template<typename T>
+        class Column {
+            public:
+                Column(HighFive::File&, const std::string&, size_t, bool);
+                void Append(const T &value) { m_buffer.push_back(value); }
+                size_t Size() const { return m_size + m_buffer.size(); }
+                void Flush();
+
+            private:
+                static HighFive::DataSet Create(HighFive::File&, const std::string&, size_t, bool);
+
+                HighFive::DataSet m_dataset;
+                std::vector<T> m_buffer;
+                size_t m_size{};
+        };
+
+        HighFive::File m_file;
+        size_t m_chunk_size;
+        StatsData results;
+
+        Column<double> m_weight, m_flux;
+        Column<int> m_remnant;
+        Column<size_t> m_offset;
+        Column<int> m_pid, m_status;
+        Column<double> m_E, m_px, m_py, m_pz, m_x, m_y, m_z;
+};
+
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define HARD_SCATTERING_HH
 
 #include "Achilles/Spinor.hh"
+#include <map>
 #include <utility>
 #include <complex>
 #include <vector>
@@ -89,6 +90,7 @@ class HardScattering {
         Process_Info m_leptonicProcess;
         bool m_fill{false};
         std::unique_ptr<NuclearModel> m_nuclear{};
+        mutable std::vector<std::map<int, std::vector<FormFactorInfo>>> m_ffInfo{};
 };
 
 }
@@ -29,6 +29,11 @@ class Integrand {
         double operator()(const std::vector<T> &point, double wgt) const { return m_func(point, wgt); }
         Func<T> Function() const { return m_func; }
         Func<T> &Function() { return m_func; }
+        // Optional function evaluating many points at once, used instead of Function if set.
+        // The batches hold MultiChannelParams::batch_size points. This is only available to
+        // integrands built with the library, as EventGen evaluates the hard scattering per point
+        BatchFunc<T> BatchFunction() const { return m_batch_func; }
+        BatchFunc<T> &BatchFunction() { return m_batch_func; }
 
         // Channel Utilities
         void AddChannel(Channel<T> channel) { 
@@ -38,9 +43,9 @@ class Integrand {
             channels.push_back(std::move(channel)); 
         }
         void RemoveChannel(int idx) { channels.erase(channels.begin() + idx); }
-        std::vector<Channel<T>> Channels() const { return channels; }
+        const std::vector<Channel<T>> &Channels() const { return channels; }
         std::vector<Channel<T>> &Channels() { return channels; }
-        Channel<T> GetChannel(size_t idx) const { return channels[idx]; }
+        const Channel<T> &GetChannel(size_t idx) const { return channels[idx]; }
         Channel<T> &GetChannel(size_t idx) { return channels[idx]; }
         size_t NChannels() const { return channels.size(); }
         size_t NDims() const { return channels[0].NDims(); }
@@ -48,36 +53,81 @@ class Integrand {
         // Train integrator
         void InitializeTrain() {
             for(auto &channel : channels) {
-                const auto grid = channel.integrator.Grid();
+                const auto &grid = channel.integrator.Grid();
                 channel.train_data.resize(grid.Dims()*grid.Bins());
             }
         }
+        // Add the squared value of the last point of the channel to the grid training data
         void AddTrainData(size_t channel, const double val2) {
-            const auto grid = channels[channel].integrator.Grid();
-            for(size_t j = 0; j < grid.Dims(); ++j) 
-                channels[channel].train_data[j * grid.Bins() + grid.FindBin(j, channels[channel].rans[j])] += val2;
+            AddGridData(channel, channels[channel].rans, val2);
+        }
+        // Add the (not squared) value of a point to the grid and stratification training data
+        void AddTrainValue(size_t channel, const std::vector<double> &rans, const double val) {
+            AddGridData(channel, rans, val * val);
+            channels[channel].integrator.AddTrainData(rans, val);
+        }
+        // Move the training data of a copy of the integrand used on another thread
+        void MergeTrainData(Integrand &other) {
+            for(size_t i = 0; i < channels.size(); ++i) {
+                auto &data = other.channels[i].train_data;
+                for(size_t j = 0; j < data.size(); ++j)
+                    channels[i].train_data[j] += data[j];
+                std::fill(data.begin(), data.end(), 0);
+                channels[i].integrator.MergeTrainData(other.channels[i].integrator);
+            }
+        }
+        // Restore the integrators saved in the YAML output, keeping the current mappings
+        bool LoadIntegrators(const YAML::Node &node) {
+            if(node["NChannels"].as<size_t>() != channels.size()) return false;
+            if(node["Channels"].size() != channels.size()) return false;
+
+            // Only modify the channels once all integrators are loaded
+            std::vector<Vegas> integrators;
+            for(size_t i = 0; i < channels.size(); ++i) {
+                integrators.push_back(node["Channels"][i]["Integrator"].as<Vegas>());
+                if(integrators.back().Grid().Dims() != channels[i].NDims()) return false;
+            }
+            for(size_t i = 0; i < channels.size(); ++i)
+                channels[i].integrator = std::move(integrators[i]);
+            return true;
+        }
+        // Copy the adapted grids from another copy of the integrand
+        void CopyGrids(const Integrand &other) {
+            for(size_t i = 0; i < channels.size(); ++i)
+                channels[i].integrator = other.channels[i].integrator;
         }
         void Train() {
             for(auto &channel : channels) {
                 if(std::all_of(channel.train_data.begin(), channel.train_data.end(),
-                               [](double i) { return i == 0; })) continue;
+                               [](double i) { return i == 0; })) {
+                    // Discard the data of the stratification, as done when adapting
+                    channel.integrator.ResetTrainData();
+                    continue;
+                }
                 channel.integrator.Adapt(channel.train_data);
                 std::fill(channel.train_data.begin(), channel.train_data.end(), 0);
             }
         }
 
+        // Enable the stratified sampling of channels not stratified yet
+        void Stratify(size_t nstrat, double beta) {
+            for(auto &channel : channels) {
+                if(!channel.integrator.Strata().Enabled())
+                    channel.integrator.Stratify(nstrat, beta);
+            }
+        }
+
         // Interface to MultiChannel integration
         void GeneratePoint(size_t channel, std::vector<double> &rans, std::vector<T> &point) const {
-            channels[channel].integrator.Grid()(rans);
+            channels[channel].integrator.GeneratePoint(rans);
             channels[channel].mapping -> GeneratePoint(point, rans); 
         }
         double GenerateWeight(const std::vector<double> &wgts, const std::vector<T> &point,
                               std::vector<double> &densities) {
             double weight{};
-            std::vector<double> rans;
             for(size_t i = 0; i < NChannels(); ++i) {
+                auto &rans = channels[i].rans;
                 densities[i] = channels[i].mapping -> GenerateWeight(point, rans);
-                channels[i].rans = rans;
                 double vw = channels[i].integrator.GenerateWeight(rans);
                 weight += wgts[i] * densities[i] / vw;
             }
@@ -86,10 +136,42 @@ class Integrand {
 
         // YAML interface
         friend YAML::convert<achilles::Integrand<T>>;
+        friend BinaryConvert<Integrand<T>>;
 
     private:
+        void AddGridData(size_t channel, const std::vector<double> &rans, const double val2) {
+            const auto &grid = channels[channel].integrator.Grid();
+            for(size_t j = 0; j < grid.Dims(); ++j) 
+                channels[channel].train_data[j * grid.Bins() + grid.FindBin(j, rans[j])] += val2;
+        }
+
         std::vector<Channel<T>> channels;
         Func<T> m_func{};
+        BatchFunc<T> m_batch_func{};
+};
+
+// The binary format only stores the integrators of the channels, since the mappings can not
+// be serialized. Reading restores the integrators into the channels of an existing integrand
+template<typename T>
+struct BinaryConvert<Integrand<T>> {
+    static void Write(BinaryWriter &out, const Integrand<T> &rhs) {
+        out.Write(rhs.channels.size());
+        for(const auto &channel : rhs.channels) out.Write(channel.integrator);
+    }
+
+    static bool Read(BinaryReader &in, Integrand<T> &rhs) {
+        if(in.Get<size_t>() != rhs.channels.size()) return false;
+
+        // Only modify the channels once all integrators are loaded
+        std::vector<Vegas> integrators(rhs.channels.size());
+        for(size_t i = 0; i < rhs.channels.size(); ++i) {
+            if(!in.Read(integrators[i])) return false;
+            if(integrators[i].Grid().Dims() != rhs.channels[i].NDims()) return false;
+        }
+        for(size_t i = 0; i < rhs.channels.size(); ++i)
+            rhs.channels[i].integrator = std::move(integrators[i]);
+        return true;
+    }
 };
 
 }
@@ -1,6 +1,7 @@
 #ifndef INTERPOLATION_HH
 #define INTERPOLATION_HH
 
+#include <array>
 #include <vector>
 
 // #include "pybind11/numpy.h"
@@ -17,6 +18,14 @@ enum class InterpolationType {
     CubicSpline
 };
 
+/// Result of an interpolation that does not throw on invalid input
+enum class InterpStatus {
+    Success,
+    BelowRange,
+    AboveRange,
+    NotInitialized
+};
+
 double Polint(const std::vector<double>&, const std::vector<double>&,
               size_t, double);
 
@@ -62,9 +71,23 @@ class Interp1D {
         ///@param x: Value to interpolate the function at
         ///@return double: The interpolated value of the function
         double operator()(const double&) const;
+
+        /// Function to perform the interpolation at the given input point without throwing.
+        /// Out of range inputs return a status and leave the result untouched, which costs
+        /// the same as an in range evaluation. The Polynomial mode allocates, and may still
+        /// throw std::bad_alloc
+        ///@param x: Value to interpolate the function at
+        ///@param result: The interpolated value of the function if successful
+        ///@return InterpStatus: Whether the interpolation succeeded
+        InterpStatus TryEvaluate(const double&, double&) const;
+
+        /// Return the second derivatives at the knots calculated by CubicSpline
+        ///@return std::vector<double>: The second derivatives at each knot
+        const std::vector<double>& SecondDerivatives() const { return derivs2; }
         ///@}
 
     private:
+        double Evaluate(double) const;
         double PolynomialInterp(double) const;
 
         InterpolationType kMode{InterpolationType::CubicSpline};
@@ -75,8 +98,10 @@ class Interp1D {
 };
 
 /// Class to perform two-dimensional interpolations of data. Currently, only Bicubic Splines are
-/// implemented as an interpolator. The Bicubic Spline is based off of the algorithm provided by
-/// Numerical Recipes.
+/// implemented as an interpolator. The Bicubic Spline is the tensor product of the natural cubic
+/// splines in each direction, and gives the same result as the algorithm provided by Numerical
+/// Recipes (splin2). The coefficients of each bicubic patch are calculated once in BicubicSpline,
+/// so evaluation only requires finding the patch and does not allocate.
 class Interp2D {
     public:
         /// @name Constructor and Destructor
@@ -128,17 +153,31 @@ class Interp2D {
         ///@param y: y-value to interpolate the fucntion at
         ///@return double: The interpolated value of the function
         double operator()(const double&, const double&) const;
+
+        /// Function to perform the interpolation at the given input point without throwing.
+        /// Out of range inputs return a status and leave the result untouched
+        ///@param x: x-value to interpolate the function at
+        ///@param y: y-value to interpolate the fucntion at
+        ///@param result: The interpolated value of the function if successful
+        ///@return InterpStatus: Whether the interpolation succeeded
+        InterpStatus TryEvaluate(const double&, const double&, double&) const;
         ///@}
 
     private:
+        double Evaluate(double, double) const;
         double NearestNeighbor(double, double) const;
         double PolynomialInterp(double, double) const;
+        double BicubicInterp(double, double) const;
+        static size_t FindCell(const std::vector<double>&, double, double);
 
         bool kSplineInit{};
         InterpolationType kMode{InterpolationType::CubicSpline};
         size_t polyOrderX{4}, polyOrderY{4};
         std::vector<double> knotX, knotY, knotZ;
-        std::vector<Interp1D> derivs2;
+        // Inverse of the knot spacing for uniform grids, zero otherwise
+        double invStepX{}, invStepY{};
+        // Value, d^2/dx^2, d^2/dy^2, and d^4/dx^2dy^2 at each knot
+        std::vector<std::array<double, 4>> coeffs;
 };
 
 }
@@ -4,6 +4,13 @@
 #include "Achilles/Vegas.hh"
 #include "Achilles/Integrand.hh"
 
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <thread>
+
 namespace achilles {
 
 struct MultiChannelSummary {
@@ -20,12 +27,17 @@ struct MultiChannelParams {
     size_t nrefine{nrefine_default};
     double beta{beta_default}, min_alpha{min_alpha_default};
     size_t iteration{};
+    // Points evaluated at once by the batch function of an integrand
+    size_t batch_size{batch_default};
+    // Strata per dimension for the stratified sampling of each channel, 0 disables it
+    size_t nstrat{nstrat_default};
 
     static constexpr size_t ncalls_default{1000}, nint_default{10};
     static constexpr double rtol_default{1e-2};
     static constexpr size_t nrefine_default{1};
     static constexpr double beta_default{0.25}, min_alpha_default{1e-5};
-    static constexpr size_t nparams = 7;
+    static constexpr size_t batch_default{1}, nstrat_default{0};
+    static constexpr size_t nparams = 9;
 };
 
 class MultiChannel {
@@ -45,11 +57,37 @@ class MultiChannel {
         template<typename T>
         void Optimize(Integrand<T>&);
 
+        // Sample the integrand without adapting until the stopping condition is met, e.g. when
+        // a number of events has been accepted. The condition is checked before each point, and
+        // a batch function evaluates one point at a time so that no point is evaluated past it
+        template<typename T>
+        void Generate(Integrand<T>&, const std::function<bool()>&);
+
+        // Multi-threaded optimization, using one copy of the integrand per thread.
+        // Each copy must be safe to evaluate independently of the others
+        template<typename T>
+        void operator()(const std::vector<Integrand<T>*>&);
+        template<typename T>
+        void Optimize(const std::vector<Integrand<T>*>&);
+
+        // Sample the events first, first + stride, ..., such that copies generating on separate
+        // threads never share an event. The events are the counters of counter-based engines
+        void SetEvents(size_t first, size_t stride=1) {
+            next_event = first;
+            event_stride = std::max(stride, size_t{1});
+        }
+        size_t NextEvent() const { return next_event; }
+
+        // Combine the last iteration of integrators run on separate threads, continuing after
+        // the last event sampled by any of them
+        void MergeIterations(const std::vector<MultiChannel>&);
+
         // Getting results
         MultiChannelSummary Summary();
 
         // YAML interface
         friend YAML::convert<achilles::MultiChannel>;
+        friend BinaryConvert<MultiChannel>;
 
     private:
         void Adapt(const std::vector<double>&);
@@ -63,50 +101,131 @@ class MultiChannel {
                     channel.integrator.Refine();
             }
         }
+        // Points of a batch, generated and evaluated before they are added to the results
+        template<typename T>
+        struct Batch {
+            std::vector<std::vector<T>> points;
+            std::vector<std::vector<double>> densities, train_rans;
+            std::vector<size_t> ichannels;
+            std::vector<double> wgts, vals;
+            size_t size{};
+
+            Batch(size_t capacity, size_t dims, size_t nchannels)
+                : points(capacity, std::vector<T>(dims)),
+                  densities(capacity, std::vector<double>(nchannels)), train_rans(capacity),
+                  ichannels(capacity), wgts(capacity), vals(capacity) {}
+        };
+        // Evaluate n points, where the k-th point is the event first + k*stride
+        template<typename T>
+        void EvaluateBatch(Integrand<T>&, size_t, size_t, size_t, Batch<T>&, bool,
+                           const std::function<bool()>& = nullptr) const;
+        template<typename T>
+        void AddBatch(Integrand<T>&, const Batch<T>&, StatsData&, std::vector<double>&, bool) const;
+        template<typename T>
+        StatsData Sample(Integrand<T>&, size_t, std::vector<double>&,
+                         const std::function<bool()>& = nullptr);
         void PrintIteration() const;
         void MaxDifference(const std::vector<double>&);
 
         size_t ndims{};
         MultiChannelParams params{};
         std::vector<double> channel_weights, best_weights;
+        AliasTable channel_sampler;
         double min_diff{lim::infinity()};
         MultiChannelSummary summary;
+        // Next event to sample, and the step between the events sampled by this copy
+        size_t next_event{}, event_stride{1};
+        // Events evaluated by each thread per round of the multi-threaded optimization
+        static constexpr size_t block_size = 1024;
 };
 
 template<typename T>
-void achilles::MultiChannel::operator()(Integrand<T> &func) {
-    size_t nchannels = channel_weights.size();
+void achilles::MultiChannel::EvaluateBatch(Integrand<T> &func, size_t first, size_t stride, size_t n,
+                                           Batch<T> &batch, bool train,
+                                           const std::function<bool()> &done) const {
     std::vector<double> rans(ndims);
-    std::vector<T> point(ndims);
-    std::vector<double> densities(nchannels);
-    std::vector<double> train_data(nchannels);
+    batch.points.resize(n, std::vector<T>(ndims));
+    batch.wgts.resize(n);
+    batch.vals.resize(n);
+    batch.size = n;
 
-    StatsData results;
-    func.InitializeTrain();
+    for(size_t k = 0; k < n; ++k) {
+        // Counter-based engines use the random numbers of the event, independent of the thread
+        Random::Instance().SetEvent(first + k*stride);
 
-    for(size_t i = 0; i < params.ncalls; ++i) {
         // Generate needed random numbers
         Random::Instance().Generate(rans);
 
         // Select a channel
-        size_t ichannel = Random::Instance().SelectIndex(channel_weights); 
+        batch.ichannels[k] = Random::Instance().SelectIndex(channel_sampler);
 
         // Map the point based on the channel
-        func.GeneratePoint(ichannel, rans, point);
+        func.GeneratePoint(batch.ichannels[k], rans, batch.points[k]);
+        batch.wgts[k] = func.GenerateWeight(channel_weights, batch.points[k], batch.densities[k]);
+        if(train) batch.train_rans[k] = func.GetChannel(batch.ichannels[k]).rans;
+    }
+
+    // Evaluate the function for the batch, using a separate substream per event
+    if(func.BatchFunction()) {
+        func.BatchFunction()(batch.points, batch.wgts, batch.vals);
+        return;
+    }
+    for(size_t k = 0; k < n; ++k) {
+        // Drop the rest of the batch once the stopping condition is met
+        if(done && k > 0 && done()) {
+            batch.size = k;
+            break;
+        }
+        Random::Instance().SetEvent(first + k*stride, 1);
+        batch.vals[k] = batch.wgts[k] == 0 ? 0 : func(batch.points[k], batch.wgts[k]);
+    }
+}
 
-        // Evaluate the function at this point
-        double wgt = func.GenerateWeight(channel_weights, point, densities);
-        double val = wgt == 0 ? 0 : func(point, wgt);
+template<typename T>
+void achilles::MultiChannel::AddBatch(Integrand<T> &func, const Batch<T> &batch, StatsData &results,
+                                      std::vector<double> &train_data, bool train) const {
+    for(size_t k = 0; k < batch.size; ++k) {
+        double val = batch.wgts[k] == 0 ? 0 : batch.vals[k];
         double val2 = val * val;
-        func.AddTrainData(ichannel, val2);
         results += val;
+        if(!train) continue;
 
+        func.AddTrainValue(batch.ichannels[k], batch.train_rans[k], val);
         if(val2 != 0) {
-            for(size_t j = 0; j < nchannels; ++j) {
-                train_data[j] += densities[j] * val2 * wgt;
+            for(size_t j = 0; j < train_data.size(); ++j) {
+                train_data[j] += batch.densities[k][j] * val2 * batch.wgts[k];
             }
         }
     }
+}
+
+template<typename T>
+achilles::StatsData achilles::MultiChannel::Sample(Integrand<T> &func, size_t ncalls,
+                                                   std::vector<double> &train_data,
+                                                   const std::function<bool()> &done) {
+    // A batch function cannot stop within a batch, so it gets single points when generating
+    const size_t batch_size = done && func.BatchFunction() ? 1 : std::max(params.batch_size, size_t{1});
+    Batch<T> batch(batch_size, ndims, channel_weights.size());
+
+    StatsData results;
+    // Generation samples without adapting, and skips collecting the training data
+    const bool train = !done;
+    for(size_t start = 0; start < ncalls; start += batch_size) {
+        if(done && done()) break;
+        EvaluateBatch(func, next_event, event_stride, std::min(batch_size, ncalls - start), batch, train, done);
+        next_event += batch.size * event_stride;
+        AddBatch(func, batch, results, train_data, train);
+    }
+
+    return results;
+}
+
+template<typename T>
+void achilles::MultiChannel::operator()(Integrand<T> &func) {
+    std::vector<double> train_data(channel_weights.size());
+
+    func.InitializeTrain();
+    StatsData results = Sample(func, params.ncalls, train_data);
 
     Adapt(train_data);
     func.Train();
@@ -115,8 +234,76 @@ void achilles::MultiChannel::operator()(Integrand<T> &func) {
     summary.sum_results += results;
 }
 
+template<typename T>
+void achilles::MultiChannel::Generate(Integrand<T> &func, const std::function<bool()> &done) {
+    std::vector<double> train_data;
+    StatsData results = Sample(func, std::numeric_limits<size_t>::max(), train_data, done);
+
+    summary.results.push_back(results);
+    summary.sum_results += results;
+}
+
+template<typename T>
+void achilles::MultiChannel::operator()(const std::vector<Integrand<T>*> &funcs) {
+    const size_t nthreads = funcs.size();
+    const size_t nchannels = channel_weights.size();
+    const size_t batch_size = std::max(params.batch_size, size_t{1});
+    const size_t nbatches = (block_size + batch_size - 1) / batch_size;
+    const size_t round_size = nthreads * nbatches * batch_size;
+
+    // Seed an independent stream per thread from the current stream, to be reproducible
+    // for a fixed number of threads
+    const unsigned int seed = Random::Instance().SplitSeed();
+
+    // Each round splits the next events into one contiguous block per thread. The points are
+    // added to the results in the order of their events, such that counter-based engines give
+    // the same results as a single thread for any number of threads
+    std::vector<std::vector<Batch<T>>> batches(nthreads, std::vector<Batch<T>>(nbatches, Batch<T>(batch_size, ndims, nchannels)));
+    std::vector<double> train_data(nchannels);
+    StatsData results;
+    funcs[0] -> InitializeTrain();
+    for(size_t start = 0, round = 0; start < params.ncalls; start += round_size, ++round) {
+        const size_t nround = std::min(round_size, params.ncalls - start);
+        std::vector<std::exception_ptr> errors(nthreads);
+        std::vector<std::thread> threads;
+        for(size_t i = 0; i < nthreads; ++i) {
+            const size_t first = next_event + i * (nround / nthreads) + std::min(i, nround % nthreads);
+            const size_t ncalls = nround / nthreads + (i < nround % nthreads ? 1 : 0);
+            threads.emplace_back([&, i, first, ncalls]() {
+                try {
+                    Random::Instance().Seed(seed, static_cast<unsigned int>(round * nthreads + i));
+                    for(size_t j = 0; j < nbatches; ++j) {
+                        const size_t offset = j * batch_size;
+                        batches[i][j].size = 0;
+                        if(offset < ncalls)
+                            EvaluateBatch(*funcs[i], first + offset, 1, std::min(batch_size, ncalls - offset),
+                                          batches[i][j], true);
+                    }
+                } catch(...) {
+                    errors[i] = std::current_exception();
+                }
+            });
+        }
+        for(auto &thread : threads) thread.join();
+        for(const auto &error : errors)
+            if(error) std::rethrow_exception(error);
+
+        for(const auto &thread_batches : batches)
+            for(const auto &batch : thread_batches) AddBatch(*funcs[0], batch, results, train_data, true);
+        next_event += nround;
+    }
+
+    Adapt(train_data);
+    funcs[0] -> Train();
+    for(size_t i = 1; i < nthreads; ++i) funcs[i] -> CopyGrids(*funcs[0]);
+    MaxDifference(train_data);
+    summary.results.push_back(results);
+    summary.sum_results += results;
+}
+
 template<typename T>
 void achilles::MultiChannel::Optimize(Integrand<T> &func) {
+    if(params.nstrat > 0) func.Stratify(params.nstrat, VegasParams::beta_default);
     double rel_err = lim::max();
     while((rel_err > params.rtol) || summary.results.size() < params.niterations) {
         (*this)(func);
@@ -128,6 +315,94 @@ void achilles::MultiChannel::Optimize(Integrand<T> &func) {
     }
 }
 
+template<typename T>
+void achilles::MultiChannel::Optimize(const std::vector<Integrand<T>*> &funcs) {
+    if(params.nstrat > 0) {
+        for(auto &func : funcs) func -> Stratify(params.nstrat, VegasParams::beta_default);
+    }
+    double rel_err = lim::max();
+    while((rel_err > params.rtol) || summary.results.size() < params.niterations) {
+        (*this)(funcs);
+        StatsData current = summary.sum_results;
+        rel_err = current.Error() / std::abs(current.Mean());
+
+        PrintIteration();
+        if(++params.iteration == params.nrefine) {
+            RefineChannels(*funcs[0]);
+            for(size_t i = 1; i < funcs.size(); ++i) funcs[i] -> CopyGrids(*funcs[0]);
+        }
+    }
+}
+
+template<>
+struct BinaryConvert<MultiChannelParams> {
+    static void Write(BinaryWriter &out, const MultiChannelParams &rhs) {
+        out.Write(rhs.ncalls);
+        out.Write(rhs.niterations);
+        out.Write(rhs.rtol);
+        out.Write(rhs.nrefine);
+        out.Write(rhs.beta);
+        out.Write(rhs.min_alpha);
+        out.Write(rhs.iteration);
+        out.Write(rhs.batch_size);
+        out.Write(rhs.nstrat);
+    }
+
+    static bool Read(BinaryReader &in, MultiChannelParams &rhs) {
+        in.Read(rhs.ncalls);
+        in.Read(rhs.niterations);
+        in.Read(rhs.rtol);
+        in.Read(rhs.nrefine);
+        in.Read(rhs.beta);
+        in.Read(rhs.min_alpha);
+        in.Read(rhs.iteration);
+        in.Read(rhs.batch_size);
+        in.Read(rhs.nstrat);
+        return true;
+    }
+};
+
+template<>
+struct BinaryConvert<MultiChannelSummary> {
+    static void Write(BinaryWriter &out, const MultiChannelSummary &rhs) {
+        out.Write(rhs.results);
+        out.Write(rhs.best_weights);
+        out.Write(rhs.sum_results);
+    }
+
+    static bool Read(BinaryReader &in, MultiChannelSummary &rhs) {
+        return in.Read(rhs.results) && in.Read(rhs.best_weights) && in.Read(rhs.sum_results);
+    }
+};
+
+template<>
+struct BinaryConvert<MultiChannel> {
+    static void Write(BinaryWriter &out, const MultiChannel &rhs) {
+        out.Write(rhs.ndims);
+        out.Write(rhs.params);
+        out.Write(rhs.channel_weights);
+        out.Write(rhs.best_weights);
+        out.Write(rhs.min_diff);
+        out.Write(rhs.summary);
+        out.Write(rhs.next_event);
+    }
+
+    static bool Read(BinaryReader &in, MultiChannel &rhs) {
+        in.Read(rhs.ndims);
+        if(!in.Read(rhs.params)) return false;
+        in.Read(rhs.channel_weights);
+        in.Read(rhs.best_weights);
+        in.Read(rhs.min_diff);
+        if(!in.Read(rhs.summary)) return false;
+        // Files written before the events were saved restart at the first event
+        rhs.next_event = 0;
+        if(in.Version() > 1) in.Read(rhs.next_event);
+        if(rhs.best_weights.size() != rhs.channel_weights.size()) return false;
+        if(!rhs.channel_weights.empty()) rhs.channel_sampler.Build(rhs.channel_weights);
+        return true;
+    }
+};
+
 }
 
 namespace YAML {
@@ -182,12 +457,15 @@ struct convert<achilles::MultiChannelParams> {
         node["beta"] = rhs.beta;
         node["min_alpha"] = rhs.min_alpha;
         node["iteration"] = rhs.iteration;
+        node["BatchSize"] = rhs.batch_size;
+        node["Stratifications"] = rhs.nstrat;
 
         return node;
     }
 
     static bool decode(const Node &node, achilles::MultiChannelParams &rhs) {
-        if(node.size() != rhs.nparams) return false;
+        // The batch size and stratifications are optional to load results written without them
+        if(node.size() > rhs.nparams || node.size() < rhs.nparams - 2) return false;
 
         rhs.ncalls = node["NCalls"].as<size_t>();
         rhs.niterations = node["NIterations"].as<size_t>();
@@ -196,6 +474,8 @@ struct convert<achilles::MultiChannelParams> {
         rhs.beta = node["beta"].as<double>();
         rhs.min_alpha = node["min_alpha"].as<double>();
         rhs.iteration = node["iteration"].as<size_t>();
+        if(node["BatchSize"]) rhs.batch_size = node["BatchSize"].as<size_t>();
+        if(node["Stratifications"]) rhs.nstrat = node["Stratifications"].as<size_t>();
 
         return true;
     }
@@ -209,11 +489,13 @@ struct convert<achilles::MultiChannel> {
         node["NChannels"] = rhs.best_weights.size();
         node["Parameters"] = rhs.params;
         node["Summary"] = rhs.summary;
+        node["NextEvent"] = rhs.next_event;
         return node;
     }
 
     static bool decode(const Node &node, achilles::MultiChannel &rhs) {
-        if(node.size() != 4) return false; 
+        // The next event is optional to load results written without it
+        if(node.size() != 4 && node.size() != 5) return false;
 
         rhs.ndims = node["NDims"].as<size_t>();
         rhs.summary = node["Summary"].as<achilles::MultiChannelSummary>();
@@ -222,7 +504,9 @@ struct convert<achilles::MultiChannel> {
         auto nchannels = node["NChannels"].as<size_t>();
         if(rhs.summary.best_weights.size() != nchannels) return false; 
         rhs.channel_weights = rhs.summary.best_weights;
+        if(nchannels > 0) rhs.channel_sampler.Build(rhs.channel_weights);
         rhs.best_weights = rhs.summary.best_weights;
+        rhs.next_event = node["NextEvent"] ? node["NextEvent"].as<size_t>() : 0;
         return true;
     }
 };
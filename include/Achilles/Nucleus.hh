@@ -55,7 +55,7 @@ class Nucleus {
         ///                to the density profile
         Nucleus() = default;
         Nucleus(const std::size_t&, const std::size_t&, const double&, const double&,
-                const std::string&, const FermiGasType&, std::unique_ptr<Density>);
+                const std::string&, const FermiGasType&, std::shared_ptr<Density>);
         Nucleus(const Nucleus&) = delete;
         Nucleus(Nucleus&&) = default;
         Nucleus& operator=(const Nucleus&) = delete;
@@ -83,7 +83,7 @@ class Nucleus {
 
         /// Set the density function to use for configuration generation
         ///@param density: The function to be use for generating nucleons
-        void SetDensity(std::unique_ptr<Density> _density) noexcept {
+        void SetDensity(std::shared_ptr<Density> _density) noexcept {
             density = std::move(_density);
         }
 
@@ -193,6 +193,12 @@ class Nucleus {
         /// Return a string representation of the nucleus
         ///@return std::string: a string representation of the nucleus
         const std::string ToString() const noexcept;
+
+        /// Create a copy of the nucleus sharing the density function, such that the
+        /// configurations are only loaded once. The copy has no potential set, since the
+        /// potential refers to the nucleus it was created for
+        ///@return std::shared_ptr<Nucleus>: The copy of the nucleus
+        std::shared_ptr<Nucleus> Clone() const;
         /// @}
 
         // Nucleus maker
@@ -232,7 +238,7 @@ class Nucleus {
         ///@param density: The density function to use to generate configurations with
         static Nucleus MakeNucleus(const std::string&, const double&, const double&,
                                    const std::string&, const FermiGasType&,
-                                   std::unique_ptr<Density>);
+                                   std::shared_ptr<Density>);
 
         /// @name Stream Operators
         /// @{
@@ -243,11 +249,14 @@ class Nucleus {
         /// @}
 
     private:
+        // Copy the nucleons into the protons and neutrons, and record their locations
+        void SortNucleons() noexcept;
+
         Particles nucleons, protons, neutrons;
         std::vector<size_t> protonLoc, neutronLoc;
         double binding{}, fermiMomentum{}, radius{};
         FermiGasType fermiGas{FermiGasType::Local};
-        std::unique_ptr<Density> density;
+        std::shared_ptr<Density> density;
         Interp1D rhoInterp;	
 
         static const std::map<std::size_t, std::string> ZToName;
@@ -149,14 +149,14 @@ namespace achilles {
         public:
             ParticleInfo(std::shared_ptr<ParticleInfoEntry> info_, const bool &anti_=false)
                 : info(std::move(info_)), anti(anti_) {
-                InitDatabase("data/Particles.yml");
+                InitDefaultDatabase();
                 if(particleDB.find(info -> id) == particleDB.end())
                     particleDB[info -> id] = info;
                 if(anti && info -> majorana == 0) anti = anti_;
             }
 
             explicit ParticleInfo(const long int &id) : info(nullptr), anti(false) {
-                InitDatabase("data/Particles.yml");
+                InitDefaultDatabase();
                 auto it(particleDB.find(static_cast<PID>(std::abs(id))));
                 if(it != particleDB.end()) 
                     info = it -> second;
@@ -166,7 +166,7 @@ namespace achilles {
             }
 
             ParticleInfo(PID id, const bool &anti_=false) : info(nullptr), anti(anti_) {
-                InitDatabase("data/Particles.yml");
+                InitDefaultDatabase();
                 if(id < PID::undefined()) {
                     id = -id;
                     anti = true;
@@ -242,6 +242,12 @@ namespace achilles {
             static const std::map<std::string, PID>& NameToPID() { return nameToPID; }
 
         private:
+            // Load the default database on first use, without creating the file name for
+            // every particle
+            static void InitDefaultDatabase() {
+                if(particleDB.empty()) InitDatabase("data/Particles.yml");
+            }
+
             std::shared_ptr<ParticleInfoEntry> info;
             bool anti;
     };
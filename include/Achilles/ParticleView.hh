@@ -0,0 +1,161 @@
+#ifndef PARTICLE_VIEW_HH
+#define PARTICLE_VIEW_HH
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include "Achilles/Particle.hh"
+
+namespace achilles {
+
+/// Selects the particles in the final state
+struct IsFinalState {
+    bool operator()(const Particle &particle) const { return particle.IsFinal(); }
+};
+
+/// Selects the particles of a given species
+struct HasPID {
+    PID pid;
+    bool operator()(const Particle &particle) const { return particle.ID() == pid; }
+};
+
+template<typename Pred>
+class FilteredParticleView;
+
+/// The ParticleView class is a non-owning view of two lists of particles, such as the hadrons
+/// and the leptons of an event, which behaves as the concatenation of the lists without
+/// copying the particles. The view is invalidated if either list is resized or destroyed.
+class ParticleView {
+    public:
+        class iterator {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = Particle;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const Particle*;
+                using reference = const Particle&;
+
+                iterator(const ParticleView *view, size_t idx) : m_view{view}, m_idx{idx} {}
+                reference operator*() const { return (*m_view)[m_idx]; }
+                pointer operator->() const { return &(*m_view)[m_idx]; }
+                iterator& operator++() { ++m_idx; return *this; }
+                iterator operator++(int) { auto tmp = *this; ++m_idx; return tmp; }
+                bool operator==(const iterator &other) const { return m_idx == other.m_idx; }
+                bool operator!=(const iterator &other) const { return m_idx != other.m_idx; }
+
+            private:
+                const ParticleView *m_view;
+                size_t m_idx;
+        };
+
+        /// @name Constructors
+        ///@{
+
+        /// View a single list of particles
+        ///@param first: The particles
+        explicit ParticleView(const std::vector<Particle> &first) : ParticleView(first, Empty()) {}
+
+        /// View the concatenation of two lists of particles
+        ///@param first: The particles at the start of the view
+        ///@param second: The particles following the first list
+        ParticleView(const std::vector<Particle> &first, const std::vector<Particle> &second)
+            : m_first{&first}, m_second{&second} {}
+        ///@}
+
+        /// @name Access
+        ///@{
+
+        size_t size() const { return m_first -> size() + m_second -> size(); }
+        bool empty() const { return size() == 0; }
+        const Particle& operator[](size_t idx) const {
+            return idx < m_first -> size() ? (*m_first)[idx] : (*m_second)[idx - m_first -> size()];
+        }
+        iterator begin() const { return {this, 0}; }
+        iterator end() const { return {this, size()}; }
+
+        /// Copy the particles into a new list
+        std::vector<Particle> ToVector() const {
+            std::vector<Particle> result;
+            result.reserve(size());
+            result.insert(result.end(), m_first -> begin(), m_first -> end());
+            result.insert(result.end(), m_second -> begin(), m_second -> end());
+            return result;
+        }
+        ///@}
+
+        /// @name Filters
+        ///@{
+
+        /// View the particles passing a selection
+        ///@param pred: The selection, called with each particle
+        template<typename Pred>
+        FilteredParticleView<Pred> Filter(Pred pred) const { return {*this, pred}; }
+        FilteredParticleView<IsFinalState> Final() const;
+        FilteredParticleView<HasPID> WithPID(PID) const;
+        ///@}
+
+    private:
+        static const std::vector<Particle>& Empty() {
+            static const std::vector<Particle> empty;
+            return empty;
+        }
+
+        const std::vector<Particle> *m_first, *m_second;
+};
+
+/// The FilteredParticleView class is a non-owning view of the particles of a ParticleView
+/// passing a selection. The selection is evaluated while iterating
+template<typename Pred>
+class FilteredParticleView {
+    public:
+        class iterator {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = Particle;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const Particle*;
+                using reference = const Particle&;
+
+                iterator(ParticleView::iterator it, ParticleView::iterator end, const Pred *pred)
+                    : m_it{it}, m_end{end}, m_pred{pred} { Skip(); }
+                reference operator*() const { return *m_it; }
+                pointer operator->() const { return m_it.operator->(); }
+                iterator& operator++() { ++m_it; Skip(); return *this; }
+                iterator operator++(int) { auto tmp = *this; ++(*this); return tmp; }
+                bool operator==(const iterator &other) const { return m_it == other.m_it; }
+                bool operator!=(const iterator &other) const { return m_it != other.m_it; }
+
+            private:
+                void Skip() { while(m_it != m_end && !(*m_pred)(*m_it)) ++m_it; }
+
+                ParticleView::iterator m_it, m_end;
+                const Pred *m_pred;
+        };
+
+        FilteredParticleView(const ParticleView &view, Pred pred) : m_view{view}, m_pred{pred} {}
+
+        iterator begin() const { return {m_view.begin(), m_view.end(), &m_pred}; }
+        iterator end() const { return {m_view.end(), m_view.end(), &m_pred}; }
+        bool empty() const { return begin() == end(); }
+        size_t size() const { return static_cast<size_t>(std::distance(begin(), end())); }
+
+        /// Copy the selected particles into a new list
+        std::vector<Particle> ToVector() const { return {begin(), end()}; }
+
+    private:
+        ParticleView m_view;
+        Pred m_pred;
+};
+
+inline FilteredParticleView<IsFinalState> ParticleView::Final() const {
+    return {*this, IsFinalState{}};
+}
+
+inline FilteredParticleView<HasPID> ParticleView::WithPID(PID pid) const {
+    return {*this, HasPID{pid}};
+}
+
+}
+
+#endif
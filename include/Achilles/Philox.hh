@@ -0,0 +1,154 @@
+#ifndef PHILOX_HH
+#define PHILOX_HH
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace achilles {
+
+/// The Philox4x32 class implements the counter-based Philox4x32-10 generator of Salmon et al.,
+/// "Parallel random numbers: as easy as 1, 2, 3" (SC11). Each block of four 32-bit numbers is a
+/// bijection of a 128-bit counter under a 64-bit key, so any position in the sequence can be
+/// reached in constant time. The counter words are used as (block, substream, event low,
+/// event high), such that each event and substream has its own sequence of 2^34 numbers.
+/// The class satisfies the UniformRandomBitGenerator requirements.
+class Philox4x32 {
+    public:
+        using result_type = uint32_t;
+        using counter_type = std::array<uint32_t, 4>;
+        using key_type = std::array<uint32_t, 2>;
+
+        /// @name Constructors
+        ///@{
+
+        /// Create a generator with the given seed as key
+        ///@param seed: The seed of the generator
+        explicit Philox4x32(uint64_t seed=0) { seed_key(seed); }
+
+        /// Create a generator with the key filled from a seed sequence
+        ///@param seq: The seed sequence
+        template<typename SeedSeq,
+                 typename=std::enable_if_t<!std::is_arithmetic_v<std::decay_t<SeedSeq>>>>
+        explicit Philox4x32(SeedSeq &&seq) { seed(std::forward<SeedSeq>(seq)); }
+        ///@}
+
+        /// @name Seeding
+        ///@{
+
+        void seed(uint64_t seed=0) { seed_key(seed); }
+
+        template<typename SeedSeq,
+                 typename=std::enable_if_t<!std::is_arithmetic_v<std::decay_t<SeedSeq>>>>
+        void seed(SeedSeq &&seq) {
+            seq.generate(m_key.begin(), m_key.end());
+            SetCounter({});
+        }
+
+        /// Set the key of the generator and restart the sequence
+        ///@param key: The new key
+        void SetKey(const key_type &key) {
+            m_key = key;
+            SetCounter({});
+        }
+
+        /// Move to the start of the sequence at the given counter
+        ///@param counter: The new counter
+        void SetCounter(const counter_type &counter) {
+            m_counter = counter;
+            m_index = m_block.size();
+        }
+
+        /// Move to the start of the sequence for an event and substream
+        ///@param event: The event number
+        ///@param substream: The substream within the event
+        void SetEvent(uint64_t event, uint32_t substream=0) {
+            SetCounter({0, substream, static_cast<uint32_t>(event),
+                        static_cast<uint32_t>(event >> 32)});
+        }
+        ///@}
+
+        /// @name Generation
+        ///@{
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+        result_type operator()() {
+            if(m_index == m_block.size()) {
+                m_block = Block(m_counter, m_key);
+                m_counter[0]++;
+                m_index = 0;
+            }
+            return m_block[m_index++];
+        }
+
+        void discard(unsigned long long n) {
+            for(; n > 0; --n) (*this)();
+        }
+
+        /// Fill a range with uniform doubles in [0, 1) with 53 bits of precision. The range is
+        /// filled from whole blocks, which are independent of each other and can be vectorized
+        ///@param first: The start of the range
+        ///@param last: The end of the range
+        void GenerateCanonical(double *first, double *last) {
+            m_index = m_block.size();
+            for(; first != last; ++first) {
+                if(m_index == m_block.size()) {
+                    m_block = Block(m_counter, m_key);
+                    m_counter[0]++;
+                    m_index = 0;
+                }
+                const uint64_t bits = (static_cast<uint64_t>(m_block[m_index]) << 32)
+                                    | m_block[m_index + 1];
+                *first = static_cast<double>(bits >> 11) * 0x1.0p-53;
+                m_index += 2;
+            }
+        }
+
+        /// Calculate the block of random numbers for a given counter and key
+        ///@param counter: The counter of the block
+        ///@param key: The key of the generator
+        ///@return counter_type: The four random numbers of the block
+        static counter_type Block(counter_type counter, key_type key) {
+            for(size_t round = 0; round < nrounds; ++round) {
+                if(round > 0) {
+                    key[0] += cWeyl0;
+                    key[1] += cWeyl1;
+                }
+                const uint64_t prod0 = static_cast<uint64_t>(cMult0)*counter[0];
+                const uint64_t prod1 = static_cast<uint64_t>(cMult1)*counter[2];
+                counter = {static_cast<uint32_t>(prod1 >> 32) ^ counter[1] ^ key[0],
+                           static_cast<uint32_t>(prod1),
+                           static_cast<uint32_t>(prod0 >> 32) ^ counter[3] ^ key[1],
+                           static_cast<uint32_t>(prod0)};
+            }
+            return counter;
+        }
+        ///@}
+
+        /// @name Getters
+        ///@{
+
+        const key_type &Key() const { return m_key; }
+        const counter_type &Counter() const { return m_counter; }
+        ///@}
+
+    private:
+        void seed_key(uint64_t seed) {
+            SetKey({static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)});
+        }
+
+        static constexpr size_t nrounds = 10;
+        static constexpr uint32_t cMult0 = 0xD2511F53, cMult1 = 0xCD9E8D57;
+        static constexpr uint32_t cWeyl0 = 0x9E3779B9, cWeyl1 = 0xBB67AE85;
+
+        key_type m_key{};
+        counter_type m_counter{}, m_block{};
+        size_t m_index{4};
+};
+
+}
+
+#endif
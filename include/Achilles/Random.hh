@@ -1,56 +1,203 @@
 #ifndef RANDOM_HH
 #define RANDOM_HH
 
-#include <memory>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
 
+#include "Achilles/Philox.hh"
 #include "Achilles/Randutils.hh"
 
 namespace achilles {
 
+/// The AliasTable class samples indices from a discrete distribution in constant time using
+/// Vose's alias method. The table is built once from the weights, after which sampling requires
+/// a single uniform random number and no allocations.
+class AliasTable {
+    public:
+        AliasTable() = default;
+        explicit AliasTable(const std::vector<double> &weights) { Build(weights); }
+
+        /// Build the table from a set of non-negative weights
+        ///@param weights: The unnormalized weights of each index
+        void Build(const std::vector<double> &weights) {
+            const size_t size = weights.size();
+            double sum = 0;
+            for(const auto &weight : weights) sum += weight;
+            if(size == 0 || !(sum > 0))
+                throw std::runtime_error("AliasTable: Weights must have a positive sum");
+
+            m_prob.resize(size);
+            m_alias.resize(size);
+            std::vector<size_t> small, large;
+            for(size_t i = 0; i < size; ++i) {
+                m_prob[i] = weights[i]*static_cast<double>(size)/sum;
+                m_alias[i] = i;
+                if(m_prob[i] < 1) small.push_back(i);
+                else large.push_back(i);
+            }
+
+            // Pair each underfull entry with an overfull entry
+            while(!small.empty() && !large.empty()) {
+                const size_t less = small.back();
+                const size_t more = large.back();
+                small.pop_back();
+                m_alias[less] = more;
+                m_prob[more] -= 1 - m_prob[less];
+                if(m_prob[more] < 1) {
+                    large.pop_back();
+                    small.push_back(more);
+                }
+            }
+
+            // Remaining entries are full up to rounding errors
+            for(const auto &idx : small) m_prob[idx] = 1;
+            for(const auto &idx : large) m_prob[idx] = 1;
+        }
+
+        /// Map a uniform random number to an index
+        ///@param rand: A uniform random number in [0, 1)
+        ///@return size_t: The selected index
+        size_t operator()(double rand) const {
+            const double x = rand*static_cast<double>(m_prob.size());
+            const size_t idx = std::min(static_cast<size_t>(x), m_prob.size() - 1);
+            return x - static_cast<double>(idx) < m_prob[idx] ? idx : m_alias[idx];
+        }
+
+        size_t Size() const { return m_prob.size(); }
+
+    private:
+        std::vector<double> m_prob;
+        std::vector<size_t> m_alias;
+};
+
+/// The Random class provides access to the random number generator of the current thread.
+/// Each thread owns an independent engine, which is seeded from system entropy until Seed is
+/// called. Two engines are available:
+///   - MersenneTwister: For reproducible multi-threaded running, each thread should seed its
+///     engine with the master seed and a unique stream id.
+///   - Philox: A counter-based engine keyed by the seed, where each event selects its own
+///     sequence with SetEvent. Event N then consumes the same random numbers independent of
+///     the thread it runs on, and of the number of threads used.
 class Random {
     public:
-        static Random Instance() {
-            static Random rand;
+        enum class Engine {
+            MersenneTwister,
+            Philox,
+        };
+
+        static Random& Instance() {
+            static thread_local Random rand;
             return rand;
         }
+        Random(const Random&) = delete;
+        Random& operator=(const Random&) = delete;
+
+        /// Select the engine for all threads. Threads that already used their generator need
+        /// to call SetEngine themselves
+        ///@param engine: The engine to use
+        static void SetDefaultEngine(Engine engine) {
+            s_engine = engine;
+            Instance().SetEngine(engine);
+        }
+        void SetEngine(Engine engine) { m_engine = engine; }
+        Engine GetEngine() const { return m_engine; }
 
         void Seed(unsigned int seed) {
-            m_rng -> seed(seed);
+            m_rng.seed(seed);
+            m_philox.engine().seed(seed);
+        }
+
+        /// Seed an independent stream, e.g. for each worker thread, from a master seed.
+        /// The seed and stream are mixed with a seed sequence, such that different streams
+        /// give statistically independent sequences. The counter-based engine is only keyed
+        /// by the seed, since its streams are selected per event with SetEvent
+        ///@param seed: The master seed
+        ///@param stream: The id of the stream
+        void Seed(unsigned int seed, unsigned int stream) {
+            randutils::seed_seq_fe128 seq{seed, stream};
+            m_rng.seed(seq);
+            m_philox.engine().seed(seed);
+        }
+
+        /// Get a seed to derive the streams of worker threads from. For the counter-based
+        /// engine, this is the key of the current thread, so that all threads share it
+        ///@return unsigned int: The seed for the worker threads
+        unsigned int SplitSeed() {
+            if(m_engine == Engine::Philox)
+                return m_philox.engine().Key()[0];
+            return m_rng.uniform(0u, std::numeric_limits<unsigned int>::max());
         }
 
+        /// Move the counter-based engine to the sequence of an event. Does nothing for the
+        /// Mersenne twister engine
+        ///@param event: The event number
+        ///@param substream: The substream within the event
+        void SetEvent(uint64_t event, uint32_t substream=0) {
+            m_event = event;
+            if(m_engine == Engine::Philox)
+                m_philox.engine().SetEvent(event, substream);
+        }
+        /// The event last set with SetEvent, e.g. to continue its random numbers on another thread
+        ///@return uint64_t: The event number
+        uint64_t CurrentEvent() const { return m_event; }
+
         void Generate(std::vector<double>& vec) {
-            m_rng -> generate<std::uniform_real_distribution>(vec);
+            if(m_engine == Engine::Philox)
+                m_philox.engine().GenerateCanonical(vec.data(), vec.data() + vec.size());
+            else
+                m_rng.generate<std::uniform_real_distribution>(vec);
         }
 
         template<typename T, size_t N>
         void Generate(std::array<T, N> &array, T low=0, T high=1) {
-            m_rng -> generate(array, low, high);
+            Visit([&](auto &rng) { rng.generate(array, low, high); });
         }
 
         template<typename T>
         T Uniform(T low, T high) {
-            return m_rng -> uniform(low, high);
+            return Visit([&](auto &rng) { return rng.uniform(low, high); });
         }
 
         template<typename T>
         T Pick(const std::vector<T> &vec) {
-            return m_rng -> pick(vec);
+            return Visit([&](auto &rng) { return rng.pick(vec); });
         }
 
         template<typename T>
         std::size_t SelectIndex(const T &array) {
-            return m_rng -> variate<std::size_t, std::discrete_distribution>(array);
+            return Visit([&](auto &rng) {
+                return rng.template variate<std::size_t, std::discrete_distribution>(array);
+            });
+        }
+
+        std::size_t SelectIndex(const AliasTable &table) {
+            return table(Uniform(0.0, 1.0));
         }
 
         std::size_t SelectIndex(const std::vector<double> &array) {
-            return m_rng -> variate<std::size_t, std::discrete_distribution>(array.begin(), array.end());
+            if(m_engine == Engine::Philox)
+                return m_philox.variate<std::size_t, std::discrete_distribution>(array.begin(), array.end());
+            return m_rng.variate<std::size_t, std::discrete_distribution>(array.begin(), array.end());
         }
 
     private:
-        Random() {
-            m_rng = std::make_shared<randutils::mt19937_rng>();
+        Random() : m_engine{s_engine.load()} {}
+
+        template<typename Func>
+        decltype(auto) Visit(Func &&func) {
+            if(m_engine == Engine::Philox) return func(m_philox);
+            return func(m_rng);
         }
-        std::shared_ptr<randutils::mt19937_rng> m_rng;
+
+        inline static std::atomic<Engine> s_engine{Engine::MersenneTwister};
+        Engine m_engine;
+        randutils::mt19937_rng m_rng;
+        randutils::random_generator<Philox4x32> m_philox;
+        uint64_t m_event{};
 };
 
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <stdexcept>
 #include <string>
@@ -84,6 +85,14 @@ class Settings {
         YAML::Node operator[](const std::string_view &key);
         bool Exists(const std::string_view &key) const;
 
+        /// Hash the content of a set of options, e.g. to detect changes between runs.
+        /// The hash is stable between runs and platforms, but sensitive to the order of keys
+        /// within each option. It includes the version of Achilles, and the content of the
+        /// files named by the options that are found in the search path
+        ///@param keys: The options to include, which do not need to exist
+        ///@return uint64_t: The hash of the options
+        uint64_t Hash(const std::vector<std::string_view> &keys) const;
+
     private:
         static YAML::Node IncludeFile(const std::string &filename);
         void CheckRequired() const;
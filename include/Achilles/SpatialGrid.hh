@@ -0,0 +1,106 @@
+#ifndef SPATIAL_GRID_HH
+#define SPATIAL_GRID_HH
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "Achilles/ThreeVector.hh"
+
+namespace achilles {
+
+class Particle;
+
+using Particles = std::vector<Particle>;
+
+/// The SpatialGrid class is a uniform cell grid over the background nucleons of a nucleus.
+/// It stores particle indices bucketed by position, so that the cascade only has to test
+/// nucleons close to the path of a propagating particle instead of the entire nucleus.
+/// Particles outside the grid bounds are stored in the nearest boundary cell.
+class SpatialGrid {
+    public:
+        /// @name Constructors and Destructor
+        ///@{
+
+        /// Create an empty grid
+        ///@param cellSize: The length of a cell edge in fm
+        SpatialGrid(double cellSize=1.0) : m_cellSize{cellSize} {}
+        SpatialGrid(const SpatialGrid&) = default;
+        SpatialGrid(SpatialGrid&&) = default;
+        SpatialGrid& operator=(const SpatialGrid&) = default;
+        SpatialGrid& operator=(SpatialGrid&&) = default;
+        ~SpatialGrid() = default;
+        ///@}
+
+        /// @name Functions
+        ///@{
+
+        /// Build the grid from the background particles of a configuration. Any previous
+        /// content of the grid is discarded.
+        ///@param particles: The particles to build the grid from
+        void Build(const Particles&);
+
+        /// Add a particle to the grid
+        ///@param idx: The index of the particle
+        ///@param position: The position of the particle
+        void Insert(std::size_t, const ThreeVector&);
+
+        /// Remove a particle from the grid. Does nothing if the particle is not in the grid
+        ///@param idx: The index of the particle
+        void Remove(std::size_t);
+
+        /// Move a particle to the cell of a new position
+        ///@param idx: The index of the particle
+        ///@param position: The new position of the particle
+        void Update(std::size_t idx, const ThreeVector &position) {
+            Remove(idx);
+            Insert(idx, position);
+        }
+
+        /// Check if a particle is currently in the grid
+        ///@param idx: The index of the particle
+        ///@return bool: True if the particle is stored in the grid
+        bool Contains(std::size_t idx) const noexcept {
+            return idx < m_cellOf.size() && m_cellOf[idx] != npos;
+        }
+
+        /// Collect all particles in cells overlapping the cylinder with axis from start to end
+        /// and the given radius. The result is a superset of the particles in the cylinder.
+        ///@param start: The start point of the cylinder axis
+        ///@param end: The end point of the cylinder axis
+        ///@param radius: The radius of the cylinder
+        ///@param result: The vector to fill with candidate indices (cleared first)
+        void Query(const ThreeVector&, const ThreeVector&, double, std::vector<std::size_t>&) const;
+
+        /// Remove all particles from the grid
+        void Clear();
+        ///@}
+
+        /// @name Getters
+        ///@{
+
+        /// Get the edge length of the grid cells
+        ///@return double: The cell size in fm
+        double CellSize() const noexcept { return m_cellSize; }
+
+        /// Get the number of particles stored in the grid
+        ///@return std::size_t: The number of particles
+        std::size_t Size() const noexcept { return m_size; }
+        ///@}
+
+    private:
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+        std::size_t CellCoord(double, std::size_t) const noexcept;
+        std::size_t CellIndex(const ThreeVector&) const noexcept;
+
+        double m_cellSize;
+        ThreeVector m_min{};
+        std::array<std::size_t, 3> m_ncells{};
+        std::vector<std::vector<std::size_t>> m_cells;
+        std::vector<std::size_t> m_cellOf;
+        std::size_t m_size{};
+};
+
+}
+
+#endif
@@ -7,6 +7,8 @@
 #include <iostream>
 #include <cmath>
 
+#include "Achilles/Binary.hh"
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wshadow"
 #include "yaml-cpp/yaml.h"
@@ -44,7 +46,14 @@ class Percentile {
             }
         }
 
+        // Add all values stored in another percentile
+        void Merge(const Percentile &other) {
+            for(const auto &x : other.m_lower) Add(x);
+            for(const auto &x : other.m_upper) Add(x);
+        }
+
         double Get() const { return m_lower.front(); }
+        size_t Size() const { return m_lower.size() + m_upper.size(); }
         
         void Clear() {
             m_lower.clear();
@@ -56,6 +65,140 @@ class Percentile {
         std::vector<double> m_lower, m_upper;
 };
 
+/// The QuantileSketch class estimates quantiles of a stream of values with bounded memory,
+/// using the KLL sketch (Karnin, Lang and Liberty, FOCS 2016). The values are stored in
+/// compactors, where a value at level h represents 2^h inputs. A full compactor is sorted and
+/// every other value is promoted to the next level, such that the memory grows only
+/// logarithmically with the number of values. Sketches can be merged, e.g. across threads.
+/// The compactions alternate between the even and odd values instead of choosing randomly, to
+/// keep the estimate reproducible without drawing from the random number generator.
+class QuantileSketch {
+    public:
+        /// Create an empty sketch
+        ///@param k: The size of the largest compactor, controlling the accuracy
+        explicit QuantileSketch(size_t k=default_k) : m_k{std::max(k, min_k)} {}
+
+        /// Create a sketch with a given normalized rank error
+        ///@param error: The target normalized rank error of a quantile estimate
+        ///@return QuantileSketch: The sketch
+        static QuantileSketch FromRankError(double error) {
+            return QuantileSketch(static_cast<size_t>(std::ceil(std::pow(cError/error, 1/cExponent))));
+        }
+
+        /// Create a sketch resolving a quantile in the tail, with a rank error of a tenth of
+        /// the fraction of values above the quantile
+        ///@param q: The quantile to be estimated
+        ///@return QuantileSketch: The sketch
+        static QuantileSketch ForQuantile(double q) {
+            return FromRankError(std::max((1 - q)/10, min_error));
+        }
+
+        void Add(double x) {
+            if(m_levels.empty()) m_levels.emplace_back();
+            m_levels[0].push_back(x);
+            m_count++;
+            m_size++;
+            if(m_size >= Capacity()) Compress();
+        }
+
+        // Add all values represented by another sketch
+        void Merge(const QuantileSketch &other) {
+            if(m_levels.size() < other.m_levels.size()) m_levels.resize(other.m_levels.size());
+            for(size_t h = 0; h < other.m_levels.size(); ++h) {
+                m_levels[h].insert(m_levels[h].end(), other.m_levels[h].begin(),
+                                   other.m_levels[h].end());
+            }
+            m_count += other.m_count;
+            m_size += other.m_size;
+            while(m_size >= Capacity()) Compress();
+        }
+
+        /// Estimate a quantile of the values
+        ///@param q: The quantile in [0, 1]
+        ///@return double: The estimated value at the quantile
+        double Quantile(double q) const {
+            if(m_count == 0) return 0;
+            std::vector<std::pair<double, size_t>> values;
+            values.reserve(m_size);
+            for(size_t h = 0; h < m_levels.size(); ++h)
+                for(const auto &x : m_levels[h]) values.emplace_back(x, size_t{1} << h);
+            std::sort(values.begin(), values.end());
+
+            const double target = std::min(std::max(q, 0.0), 1.0)*static_cast<double>(m_count);
+            size_t rank = 0;
+            for(const auto &value : values) {
+                rank += value.second;
+                if(static_cast<double>(rank) >= target) return value.first;
+            }
+            return values.back().first;
+        }
+
+        /// Estimate the normalized rank error of a quantile, with 99% confidence
+        ///@return double: The rank error as a fraction of the number of values
+        double RankError() const { return cError/std::pow(static_cast<double>(m_k), cExponent); }
+
+        size_t K() const { return m_k; }
+        size_t Count() const { return m_count; }
+        // Number of values stored in the sketch
+        size_t Size() const { return m_size; }
+
+        void Clear() {
+            m_levels.clear();
+            m_count = 0;
+            m_size = 0;
+        }
+
+        static constexpr size_t default_k = 200, min_k = 8;
+        // Smallest rank error chosen for a quantile, bounding the size of the sketch
+        static constexpr double min_error = 1e-4;
+
+    private:
+        // Calibration of the rank error of the KLL sketch from the Apache DataSketches library
+        static constexpr double cError = 2.296, cExponent = 0.9723;
+        // Ratio of the capacities of neighbouring levels
+        static constexpr double cDecay = 2.0/3.0;
+
+        size_t LevelCapacity(size_t level) const {
+            const auto depth = static_cast<double>(m_levels.size() - level - 1);
+            const auto capacity = static_cast<size_t>(std::ceil(static_cast<double>(m_k)*std::pow(cDecay, depth)));
+            return std::max(capacity, size_t{2});
+        }
+
+        size_t Capacity() const {
+            size_t capacity = 0;
+            for(size_t h = 0; h < m_levels.size(); ++h) capacity += LevelCapacity(h);
+            return capacity;
+        }
+
+        // Compact the lowest full level into the next level
+        void Compress() {
+            for(size_t h = 0; h < m_levels.size(); ++h) {
+                if(m_levels[h].size() < LevelCapacity(h)) continue;
+                if(h + 1 == m_levels.size()) m_levels.emplace_back();
+
+                auto &level = m_levels[h];
+                std::sort(level.begin(), level.end());
+                // Keep the largest value if the number of values is odd
+                const size_t npairs = level.size()/2;
+                for(size_t i = 0; i < npairs; ++i)
+                    m_levels[h + 1].push_back(level[2*i + (m_odd ? 1 : 0)]);
+                m_odd = !m_odd;
+                if(level.size() % 2 == 1) {
+                    level.front() = level.back();
+                    level.resize(1);
+                } else {
+                    level.clear();
+                }
+                m_size -= npairs;
+                return;
+            }
+        }
+
+        size_t m_k;
+        std::vector<std::vector<double>> m_levels;
+        size_t m_count{}, m_size{};
+        bool m_odd{};
+};
 
 // Structure to hold moments
 class StatsData {
@@ -83,6 +226,13 @@ class StatsData {
         StatsData operator+(double x) {
             return {*this += x};
         }
+        // Add calls with zero weight, as for events failing the cuts or the unweighting
+        void AddZeros(size_t ncalls) {
+            if(ncalls == 0) return;
+            n += static_cast<double>(ncalls);
+            min = std::min(min, 0.0);
+            max = std::max(max, 0.0);
+        }
         StatsData& operator+=(StatsData x) {
             n += x.n;
             n_finite += x.n_finite;
@@ -116,11 +266,26 @@ class StatsData {
         bool operator!=(const StatsData &other) const { return !(*this == other); }
 
         friend YAML::convert<achilles::StatsData>;
+        friend BinaryConvert<StatsData>;
 
     private:
         double n{}, min{lim::max()}, max{lim::min()}, sum{}, sum2{}, n_finite{};
 };
 
+template<>
+struct BinaryConvert<StatsData> {
+    static void Write(BinaryWriter &out, const StatsData &rhs) {
+        for(const auto &x : {rhs.n, rhs.min, rhs.max, rhs.sum, rhs.sum2, rhs.n_finite})
+            out.Write(x);
+    }
+
+    static bool Read(BinaryReader &in, StatsData &rhs) {
+        for(auto *x : {&rhs.n, &rhs.min, &rhs.max, &rhs.sum, &rhs.sum2, &rhs.n_finite})
+            in.Read(*x);
+        return true;
+    }
+};
+
 }
 
 namespace YAML {
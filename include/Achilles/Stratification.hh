@@ -0,0 +1,164 @@
+#ifndef STRATIFICATION_HH
+#define STRATIFICATION_HH
+
+#include <vector>
+
+#include "Achilles/AdaptiveMap.hh"
+#include "Achilles/Random.hh"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wshadow"
+#include "yaml-cpp/yaml.h"
+#pragma GCC diagnostic pop
+
+namespace achilles {
+
+/// The Stratification class implements the adaptive stratified sampling of VEGAS+
+/// (G. P. Lepage, J. Comput. Phys. 439 (2021) 110386). The unit hypercube in front of the
+/// adaptive map is divided into nstrat^ndims equal hypercubes, and each hypercube is sampled
+/// with a probability proportional to a power of the root mean square of the integrand in it.
+/// Unlike the separable map, this captures correlations between the dimensions. The hypercube
+/// is selected at random for each point instead of filling each hypercube with a fixed number
+/// of points, such that the sampling can be combined with the random channel selection of the
+/// MultiChannel integrator.
+class Stratification {
+    public:
+        /// @name Constructors
+        ///@{
+
+        /// Create a disabled stratification
+        Stratification() = default;
+
+        /// Create a stratification with uniform sampling probabilities
+        ///@param dims: The number of dimensions
+        ///@param nstrat: The number of strata per dimension, reduced if the total number of
+        ///               hypercubes exceeds the maximum allowed
+        Stratification(size_t dims, size_t nstrat);
+        ///@}
+
+        /// @name Sampling
+        ///@{
+
+        /// Move a uniform point into a randomly selected hypercube
+        ///@param rans: The uniform random numbers, updated to the point in the hypercube
+        ///@return double: The weight of the point, given by the ratio of the volume of the
+        ///                hypercube to its probability
+        double operator()(std::vector<double>&) const;
+
+        /// Calculate the weight of a point after the adaptive map
+        ///@param grid: The adaptive map following the stratification
+        ///@param x: The point after the adaptive map
+        ///@return double: The weight of the point
+        double GenerateWeight(const AdaptiveMap&, const std::vector<double>&) const;
+
+        /// Find the hypercube containing a point after the adaptive map
+        ///@param grid: The adaptive map following the stratification
+        ///@param x: The point after the adaptive map
+        ///@return size_t: The index of the hypercube
+        size_t FindCube(const AdaptiveMap&, const std::vector<double>&) const;
+        ///@}
+
+        /// @name Training
+        ///@{
+
+        /// Accumulate the integrand value of a point
+        ///@param grid: The adaptive map following the stratification
+        ///@param x: The point after the adaptive map
+        ///@param val: The weighted integrand value of the point
+        void AddTrainData(const AdaptiveMap&, const std::vector<double>&, double);
+
+        /// Move the accumulated training data of another stratification into this one
+        ///@param other: The stratification to take the data from
+        void MergeTrainData(Stratification&);
+
+        /// Discard the accumulated training data without adapting
+        void ResetTrainData();
+
+        /// Update the sampling probabilities from the accumulated data and reset the data
+        ///@param beta: The damping exponent of the root mean squares, between 0 (no
+        ///             stratification) and 1 (optimal allocation)
+        void Adapt(double);
+        ///@}
+
+        /// @name Getters and Setters
+        ///@{
+
+        bool Enabled() const { return m_nstrat > 0; }
+        size_t Dims() const { return m_dims; }
+        size_t Strata() const { return m_nstrat; }
+        size_t NCubes() const { return m_prob.size(); }
+        const std::vector<double> &Probabilities() const { return m_prob; }
+
+        /// Set the sampling probabilities of the hypercubes
+        ///@param prob: The probabilities, one per hypercube
+        void SetProbabilities(std::vector<double>);
+        ///@}
+
+        static constexpr size_t max_cubes = 1 << 16;
+
+        friend BinaryConvert<Stratification>;
+
+    private:
+        // Fraction of the uniform distribution mixed into the adapted probabilities
+        static constexpr double cMix = 0.1;
+
+        size_t m_dims{}, m_nstrat{};
+        std::vector<double> m_prob;
+        AliasTable m_sampler;
+        std::vector<double> m_sum, m_sum2;
+        std::vector<size_t> m_count;
+};
+
+template<>
+struct BinaryConvert<Stratification> {
+    static void Write(BinaryWriter &out, const Stratification &rhs) {
+        out.Write(rhs.m_dims);
+        out.Write(rhs.m_nstrat);
+        out.Write(rhs.m_prob);
+    }
+
+    static bool Read(BinaryReader &in, Stratification &rhs) {
+        const auto dims = in.Get<size_t>();
+        const auto nstrat = in.Get<size_t>();
+        auto prob = in.Get<std::vector<double>>();
+        rhs = Stratification(dims, nstrat);
+        if(rhs.Strata() != nstrat || prob.size() != rhs.NCubes()) return false;
+        if(rhs.Enabled()) rhs.SetProbabilities(std::move(prob));
+        return true;
+    }
+};
+
+}
+
+namespace YAML {
+
+template<>
+struct convert<achilles::Stratification> {
+    static Node encode(const achilles::Stratification &rhs) {
+        Node node;
+        node["ndims"] = rhs.Dims();
+        node["nstrat"] = rhs.Strata();
+        node["probs"] = rhs.Probabilities();
+        node["probs"].SetStyle(YAML::EmitterStyle::Flow);
+        return node;
+    }
+
+    static bool decode(const Node &node, achilles::Stratification &rhs) {
+        if(node.size() != 3) return false;
+
+        auto ndims = node["ndims"].as<size_t>();
+        auto nstrat = node["nstrat"].as<size_t>();
+        rhs = achilles::Stratification(ndims, nstrat);
+
+        // Ensure the stratification was not reduced to a different number of hypercubes
+        auto probs = node["probs"].as<std::vector<double>>();
+        if(rhs.Strata() != nstrat || probs.size() != rhs.NCubes()) return false;
+        if(rhs.Enabled()) rhs.SetProbabilities(std::move(probs));
+
+        return true;
+    }
+};
+
+}
+
+#endif
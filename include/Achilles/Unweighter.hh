@@ -19,11 +19,32 @@ class Unweighter {
 
         virtual void AddEvent(const Event&) = 0;
         virtual bool AcceptEvent(Event&) = 0;
+        virtual std::unique_ptr<Unweighter> Clone() const = 0;
+
+        // Add the events used for training by an unweighter on another thread
+        virtual void AddEvents(const Unweighter&) = 0;
+
+        // Save and restore the trained state, to skip the training in later runs
+        virtual YAML::Node ToYAML() const = 0;
+        virtual bool FromYAML(const YAML::Node&) = 0;
+
+        // Combine the statistics of an unweighter used on another thread
+        void Merge(const Unweighter &other) {
+            m_accepted += other.m_accepted;
+            m_total += other.m_total;
+        }
 
         double Efficiency() const { return static_cast<double>(m_accepted) / static_cast<double>(m_total); }
         size_t Accepted() const { return m_accepted; }
 
+        // The maximum weight used to unweight events, and its estimated uncertainty
+        virtual double MaxWeight() const { return 0; }
+        virtual double MaxWeightError() const { return 0; }
+
     protected:
+        // Accept an event with probability weight / max_wgt
+        bool AcceptWeight(Event&, double max_wgt);
+
         size_t m_accepted{}, m_total{};
 };
 
@@ -35,7 +56,19 @@ class NoUnweighter : public Unweighter, RegistrableUnweighter<NoUnweighter> {
     public:
         NoUnweighter(const YAML::Node&) {}
         void AddEvent(const Event&) override {}
+        void AddEvents(const Unweighter&) override {}
+        YAML::Node ToYAML() const override {
+            YAML::Node node;
+            node["Name"] = Name();
+            return node;
+        }
+        bool FromYAML(const YAML::Node &node) override {
+            return node["Name"].as<std::string>() == Name();
+        }
         bool AcceptEvent(Event&) override { m_accepted++; m_total++; return true; }
+        std::unique_ptr<Unweighter> Clone() const override {
+            return std::make_unique<NoUnweighter>(*this);
+        }
 
         // Required factory methods
         static std::unique_ptr<Unweighter> Construct(const YAML::Node &node) {
@@ -48,7 +81,16 @@ class PercentileUnweighter : public Unweighter, RegistrableUnweighter<Percentile
     public:
         PercentileUnweighter(const YAML::Node&);
         void AddEvent(const Event&) override;
+        void AddEvents(const Unweighter&) override;
+        YAML::Node ToYAML() const override;
+        bool FromYAML(const YAML::Node&) override;
         bool AcceptEvent(Event&) override;
+        std::unique_ptr<Unweighter> Clone() const override {
+            return std::make_unique<PercentileUnweighter>(*this);
+        }
+        double MaxWeight() const override {
+            return m_percentile.Size() > 0 ? m_percentile.Get() : 0;
+        }
 
         // Required factory methods
         static std::unique_ptr<Unweighter> Construct(const YAML::Node&);
@@ -58,6 +100,37 @@ class PercentileUnweighter : public Unweighter, RegistrableUnweighter<Percentile
         Percentile m_percentile;
 };
 
+// Unweighter using a bounded-memory estimate of the percentile of the weights, which can be
+// merged across threads. The accuracy is set by the target rank error of the percentile, which
+// defaults to a tenth of the fraction of weights above the percentile
+class QuantileUnweighter : public Unweighter, RegistrableUnweighter<QuantileUnweighter> {
+    public:
+        QuantileUnweighter(const YAML::Node&);
+        void AddEvent(const Event&) override;
+        void AddEvents(const Unweighter&) override;
+        YAML::Node ToYAML() const override;
+        bool FromYAML(const YAML::Node&) override;
+        bool AcceptEvent(Event&) override;
+        std::unique_ptr<Unweighter> Clone() const override {
+            return std::make_unique<QuantileUnweighter>(*this);
+        }
+        double MaxWeight() const override;
+        double MaxWeightError() const override;
+
+        // Required factory methods
+        static std::unique_ptr<Unweighter> Construct(const YAML::Node&);
+        static std::string Name() { return "Quantile"; }
+
+    private:
+        void Update() const;
+
+        double m_quantile;
+        QuantileSketch m_sketch;
+        // The estimate is only updated after adding new events
+        mutable double m_max_wgt{}, m_max_wgt_error{};
+        mutable bool m_updated{true};
+};
+
 }
 
 #endif
@@ -15,6 +15,7 @@
 
 #include "Achilles/AdaptiveMap.hh"
 #include "Achilles/Statistics.hh"
+#include "Achilles/Stratification.hh"
 #include "Achilles/Random.hh"
 
 #include "spdlog/spdlog.h"
@@ -41,14 +42,25 @@ class KBNSummation{
 template<typename T>
 using Func = std::function<double(const std::vector<T>&, const double&)>;
 
+// Evaluate a batch of points with their phase space weights, filling one result per point
+template<typename T>
+using BatchFunc = std::function<void(const std::vector<std::vector<T>>&, const std::vector<double>&,
+                                     std::vector<double>&)>;
+
 struct VegasParams {
     size_t ncalls{ncalls_default}, nrefine{nrefine_default};
     double rtol{rtol_default}, atol{atol_default}, alpha{alpha_default};
     size_t ninterations{nitn_default};
+    // Strata per dimension for the VEGAS+ stratified sampling (0 disables it), and the damping
+    // exponent used to redistribute the points between the hypercubes
+    size_t nstrat{nstrat_default};
+    double beta{beta_default};
 
     static constexpr size_t nitn_default = 10, ncalls_default = 10000, nrefine_default = 5;
     static constexpr double alpha_default = 1.5, rtol_default = 1e-4, atol_default = 1e-4;
-    static constexpr size_t nparams = 6;
+    static constexpr size_t nstrat_default = 0;
+    static constexpr double beta_default = 0.75;
+    static constexpr size_t nparams = 8;
 };
 
 struct VegasSummary {
@@ -68,7 +80,9 @@ class Vegas {
         };
 
         Vegas() = default;
-        Vegas(AdaptiveMap map, VegasParams _params) : grid{std::move(map)}, params{std::move(_params)} {}
+        Vegas(AdaptiveMap map, VegasParams _params) : grid{std::move(map)}, params{std::move(_params)} {
+            if(params.nstrat > 0) strat = Stratification(grid.Dims(), params.nstrat);
+        }
 
         // Utilities
         void SetVerbosity(size_t v = 1) {
@@ -78,8 +92,15 @@ class Vegas {
             else if(v == 3) verbosity = Verbosity::very_verbose;
             else throw std::runtime_error("Vegas: Invalid verbosity level");
         }
-        AdaptiveMap Grid() const { return grid; }
+        const AdaptiveMap &Grid() const { return grid; }
         AdaptiveMap &Grid() { return grid; }
+        const Stratification &Strata() const { return strat; }
+        // Enable the stratified sampling, resetting the probabilities of the hypercubes
+        void Stratify(size_t nstrat, double beta=VegasParams::beta_default) {
+            params.nstrat = nstrat;
+            params.beta = beta;
+            strat = Stratification(grid.Dims(), nstrat);
+        }
         // bool Serialize(std::ostream &out) const {
         //     
         // }
@@ -87,7 +108,11 @@ class Vegas {
         // Training the integratvegor
         void operator()(const Func<double>&);
         void Optimize(const Func<double>&);
+        double GeneratePoint(std::vector<double>&) const;
         double GenerateWeight(const std::vector<double>&) const;
+        void AddTrainData(const std::vector<double>&, double);
+        void MergeTrainData(Vegas&);
+        void ResetTrainData();
         void Adapt(const std::vector<double>&);
         void Refine();
 
@@ -98,16 +123,71 @@ class Vegas {
 
         // YAML interface
         friend YAML::convert<achilles::Vegas>;
+        friend BinaryConvert<Vegas>;
 
     private:
         void PrintIteration() const;
 
         AdaptiveMap grid;
+        Stratification strat;
         VegasSummary summary;
         VegasParams params{};
         Verbosity verbosity{Verbosity::normal};
 };
 
+template<>
+struct BinaryConvert<VegasParams> {
+    static void Write(BinaryWriter &out, const VegasParams &rhs) {
+        out.Write(rhs.ncalls);
+        out.Write(rhs.nrefine);
+        out.Write(rhs.rtol);
+        out.Write(rhs.atol);
+        out.Write(rhs.alpha);
+        out.Write(rhs.ninterations);
+        out.Write(rhs.nstrat);
+        out.Write(rhs.beta);
+    }
+
+    static bool Read(BinaryReader &in, VegasParams &rhs) {
+        in.Read(rhs.ncalls);
+        in.Read(rhs.nrefine);
+        in.Read(rhs.rtol);
+        in.Read(rhs.atol);
+        in.Read(rhs.alpha);
+        in.Read(rhs.ninterations);
+        in.Read(rhs.nstrat);
+        in.Read(rhs.beta);
+        return true;
+    }
+};
+
+template<>
+struct BinaryConvert<VegasSummary> {
+    static void Write(BinaryWriter &out, const VegasSummary &rhs) {
+        out.Write(rhs.results);
+        out.Write(rhs.sum_results);
+    }
+
+    static bool Read(BinaryReader &in, VegasSummary &rhs) {
+        return in.Read(rhs.results) && in.Read(rhs.sum_results);
+    }
+};
+
+template<>
+struct BinaryConvert<Vegas> {
+    static void Write(BinaryWriter &out, const Vegas &rhs) {
+        out.Write(rhs.grid);
+        out.Write(rhs.strat);
+        out.Write(rhs.summary);
+        out.Write(rhs.params);
+    }
+
+    static bool Read(BinaryReader &in, Vegas &rhs) {
+        return in.Read(rhs.grid) && in.Read(rhs.strat) && in.Read(rhs.summary)
+            && in.Read(rhs.params);
+    }
+};
+
 }
 
 namespace YAML {
@@ -146,14 +226,23 @@ struct convert<achilles::Vegas> {
         Node node;
         node["Grid"] = rhs.grid;
         node["Summary"] = rhs.summary;
+        if(rhs.strat.Enabled()) node["Stratification"] = rhs.strat;
         return node;
     }
 
     static bool decode(const Node &node, achilles::Vegas &rhs) {
-        if(node.size() != 2) return false;
+        // The stratification is only stored if enabled
+        if(node.size() != 2 && node.size() != 3) return false;
 
         rhs.grid = node["Grid"].as<achilles::AdaptiveMap>();
         rhs.summary = node["Summary"].as<achilles::VegasSummary>();
+        if(node["Stratification"]) {
+            rhs.strat = node["Stratification"].as<achilles::Stratification>();
+            rhs.params.nstrat = rhs.strat.Strata();
+        } else {
+            rhs.strat = achilles::Stratification();
+            rhs.params.nstrat = 0;
+        }
         return true;
     }
 };
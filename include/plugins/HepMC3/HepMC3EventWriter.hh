@@ -11,6 +11,9 @@
 #pragma GCC diagnostic ignored "-Wdouble-promotion"
 #elif defined(__GNUC__) || defined(__GNUG__)
 #endif
+#include "HepMC3/Attribute.h"
+#include "HepMC3/GenCrossSection.h"
+#include "HepMC3/GenEvent.h"
 #include "HepMC3/WriterAscii.h"
 #pragma GCC diagnostic pop
 
@@ -18,17 +21,27 @@ namespace achilles {
 
 class HepMC3Writer : public EventWriter {
     public:
-        HepMC3Writer(const std::string &filename, bool zipped=true) 
-            : file{InitializeStream(filename, zipped)} {}
+        HepMC3Writer(const std::string &filename, bool zipped=true, size_t threads=0)
+            : file{InitializeStream(filename, zipped, threads)} {}
         ~HepMC3Writer() override = default;
 
         void WriteHeader(const std::string&) override;
         void Write(const Event&) override;
+        void AddTrials(size_t ntrials) override {
+            results.AddZeros(ntrials);
+        }
 
     private:
-        static std::shared_ptr<std::ostream> InitializeStream(const std::string&, bool);
+        static std::shared_ptr<std::ostream> InitializeStream(const std::string&, bool, size_t);
         HepMC3::WriterAscii file;
         achilles::StatsData results;
+
+        // Event record and attributes reused between events
+        HepMC3::GenEvent m_event{HepMC3::Units::MEV, HepMC3::Units::MM};
+        std::shared_ptr<HepMC3::IntAttribute> m_interaction_type{std::make_shared<HepMC3::IntAttribute>(1)};
+        std::shared_ptr<HepMC3::GenCrossSection> m_cross_section{std::make_shared<HepMC3::GenCrossSection>()};
+        std::shared_ptr<HepMC3::DoubleAttribute> m_flux{std::make_shared<HepMC3::DoubleAttribute>()};
+        std::vector<HepMC3::GenParticlePtr> m_converted;
 };
 
 }
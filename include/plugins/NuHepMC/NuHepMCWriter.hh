@@ -7,6 +7,9 @@
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wsign-conversion"
 #pragma GCC diagnostic ignored "-Wconversion"
+#include "HepMC3/Attribute.h"
+#include "HepMC3/GenCrossSection.h"
+#include "HepMC3/GenEvent.h"
 #include "HepMC3/WriterAscii.h"
 #pragma GCC diagnostic pop
 
@@ -14,17 +17,29 @@ namespace achilles {
 
 class NuHepMCWriter : public EventWriter {
     public:
-        NuHepMCWriter(const std::string &filename, bool zipped=true) 
-            : file{InitializeStream(filename, zipped)} {}
+        NuHepMCWriter(const std::string &filename, bool zipped=true, size_t threads=0)
+            : file{InitializeStream(filename, zipped, threads)} {}
         ~NuHepMCWriter() override = default;
 
         void WriteHeader(const std::string&) override;
         void Write(const Event&) override;
+        void AddTrials(size_t ntrials) override {
+            results.AddZeros(ntrials);
+        }
 
     private:
-        static std::shared_ptr<std::ostream> InitializeStream(const std::string&, bool);
+        static std::shared_ptr<std::ostream> InitializeStream(const std::string&, bool, size_t);
         HepMC3::WriterAscii file;
         achilles::StatsData results;
+
+        // Event record and attributes reused between events
+        HepMC3::GenEvent m_event{HepMC3::Units::MEV, HepMC3::Units::MM};
+        std::shared_ptr<HepMC3::IntAttribute> m_proc_id{std::make_shared<HepMC3::IntAttribute>(101)};
+        std::shared_ptr<HepMC3::GenCrossSection> m_cross_section{std::make_shared<HepMC3::GenCrossSection>()};
+        std::shared_ptr<HepMC3::DoubleAttribute> m_flux{std::make_shared<HepMC3::DoubleAttribute>()};
+        std::shared_ptr<HepMC3::VectorDoubleAttribute> m_labpos{
+            std::make_shared<HepMC3::VectorDoubleAttribute>(std::vector<double>{0, 0, 0, 0})};
+        std::vector<HepMC3::GenParticlePtr> m_converted;
         static constexpr std::array<int, 3> version{0, 1, 0};
 };
 
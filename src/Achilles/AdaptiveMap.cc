@@ -13,6 +13,7 @@ using achilles::AdaptiveMap;
 bool AdaptiveMap::Deserialize(std::istream &in) {
     in >> m_bins >> m_dims;
     m_hist.resize((m_bins + 1) * m_dims);
+    m_uniform = false;
 
     for(auto &x : m_hist) in >> x;
 
@@ -31,12 +32,26 @@ bool AdaptiveMap::Serialize(std::ostream &out) const {
 }
 
 size_t AdaptiveMap::FindBin(size_t dim, double x) const {
-    const auto edges = Edges(dim);
-    auto it = std::lower_bound(edges.begin(), edges.end(), x);
-    return static_cast<size_t>(std::distance(edges.begin(), it))-1;
+    if(m_uniform) {
+        const auto position = x * static_cast<double>(m_bins);
+        if(position <= 0) return 0;
+        return std::min(static_cast<size_t>(position), m_bins - 1);
+    }
+
+    const double *begin = EdgesBegin(dim);
+    const double *it = std::lower_bound(begin + 1, EdgesEnd(dim) - 1, x);
+    return static_cast<size_t>(it - begin) - 1;
+}
+
+double AdaptiveMap::Inverse(size_t dim, double x) const {
+    const auto index = FindBin(dim, x);
+    const double size = width(dim, index);
+    double loc = size > 0 ? (x - lower_edge(dim, index)) / size : 0;
+    loc = std::min(std::max(loc, 0.0), 1.0);
+    return (static_cast<double>(index) + loc) / static_cast<double>(m_bins);
 }
 
-double AdaptiveMap::operator()(std::vector<double> &rans) {
+double AdaptiveMap::operator()(std::vector<double> &rans) const {
     double jacobian = 1.0;
     for(std::size_t i = 0; i < m_dims; ++i) {
         const auto position = rans[i] * static_cast<double>(m_bins);
@@ -122,6 +137,7 @@ void AdaptiveMap::Adapt(const double &alpha, const std::vector<double> &data) {
     }
 
     m_hist = new_hist;
+    m_uniform = false;
     spdlog::trace("Updated Histogram: [{}]", fmt::join(m_hist.begin(), m_hist.end(), ", "));
 }
 
@@ -0,0 +1,25 @@
+#include "Achilles/AllocationCounter.hh"
+
+namespace {
+
+// Only set during the static initialization, before any thread is started
+bool enabled = false;
+thread_local size_t allocations = 0;
+
+}
+
+void achilles::AllocationCounter::Enable() noexcept {
+    enabled = true;
+}
+
+bool achilles::AllocationCounter::Enabled() noexcept {
+    return enabled;
+}
+
+void achilles::AllocationCounter::Record() noexcept {
+    ++allocations;
+}
+
+size_t achilles::AllocationCounter::Count() noexcept {
+    return allocations;
+}
@@ -0,0 +1,155 @@
+#include "Achilles/BGZFStream.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "fmt/format.h"
+#include "spdlog/spdlog.h"
+#include "zlib.h"
+
+using achilles::BGZFStreamBuf;
+
+namespace {
+
+// Gzip header with the BGZF extra field, excluding the block size
+constexpr unsigned char header[] = {31, 139, 8, 4, 0, 0, 0, 0, 0, 255, 6, 0, 'B', 'C', 2, 0};
+constexpr size_t header_size = sizeof(header) + 2;
+constexpr size_t footer_size = 8;
+
+void PutLE(std::string &out, size_t pos, uint32_t value, size_t nbytes) {
+    for(size_t i = 0; i < nbytes; ++i)
+        out[pos + i] = static_cast<char>((value >> (8*i)) & 0xff);
+}
+
+}
+
+const std::string BGZFStreamBuf::eof_marker = BGZFStreamBuf::CompressBlock({});
+
+BGZFStreamBuf::BGZFStreamBuf(const std::string &filename, size_t nthreads, int level)
+        : m_file{filename, std::ios::binary}, m_level{level},
+          m_jobs{2*std::max(nthreads, size_t{1})}, m_max_pending{4*std::max(nthreads, size_t{1})} {
+    m_block.reserve(block_size);
+    for(size_t i = 0; i < std::max(nthreads, size_t{1}); ++i)
+        m_threads.emplace_back([this]() { Compress(); });
+}
+
+BGZFStreamBuf::~BGZFStreamBuf() {
+    try {
+        Close();
+    } catch(const std::exception &error) {
+        spdlog::error("BGZFStream: Failed to close the file: {}", error.what());
+    }
+}
+
+void BGZFStreamBuf::Close() {
+    if(m_threads.empty()) return;
+
+    // Stop the workers even if writing the remaining blocks fails
+    try {
+        if(!m_block.empty()) SubmitBlock();
+        while(!m_pending.empty()) WriteBlock();
+    } catch(...) {
+        m_jobs.Close();
+        for(auto &thread : m_threads) thread.join();
+        m_threads.clear();
+        throw;
+    }
+    m_jobs.Close();
+    for(auto &thread : m_threads) thread.join();
+    m_threads.clear();
+
+    m_file.write(eof_marker.data(), static_cast<std::streamsize>(eof_marker.size()));
+    m_file.close();
+    if(m_file.fail()) throw std::runtime_error("BGZFStream: Failed to write the file");
+}
+
+std::string BGZFStreamBuf::CompressBlock(const std::vector<char> &data, int level) {
+    if(data.size() > block_size)
+        throw std::runtime_error("BGZFStream: Block exceeds the maximum size");
+
+    z_stream stream{};
+    if(deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        throw std::runtime_error("BGZFStream: Failed to initialize zlib");
+    const auto bound = deflateBound(&stream, data.size());
+
+    std::string block(header_size + bound + footer_size, '\0');
+    std::memcpy(block.data(), header, sizeof(header));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(block.data() + header_size);
+    stream.avail_out = static_cast<uInt>(bound);
+    const int status = deflate(&stream, Z_FINISH);
+    const size_t compressed = stream.total_out;
+    deflateEnd(&stream);
+    if(status != Z_STREAM_END)
+        throw std::runtime_error(fmt::format("BGZFStream: Compression failed with status {}", status));
+
+    // Fill in the size of the block, and the checksum and size of the data
+    block.resize(header_size + compressed + footer_size);
+    const auto crc = crc32(crc32(0, nullptr, 0), reinterpret_cast<const Bytef*>(data.data()),
+                           static_cast<uInt>(data.size()));
+    PutLE(block, sizeof(header), static_cast<uint32_t>(block.size() - 1), 2);
+    PutLE(block, header_size + compressed, static_cast<uint32_t>(crc), 4);
+    PutLE(block, header_size + compressed + 4, static_cast<uint32_t>(data.size()), 4);
+    return block;
+}
+
+BGZFStreamBuf::int_type BGZFStreamBuf::overflow(int_type c) {
+    if(traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+    m_block.push_back(traits_type::to_char_type(c));
+    if(m_block.size() == block_size) SubmitBlock();
+    return c;
+}
+
+std::streamsize BGZFStreamBuf::xsputn(const char *data, std::streamsize count) {
+    auto remaining = static_cast<size_t>(count);
+    while(remaining > 0) {
+        const size_t size = std::min(remaining, block_size - m_block.size());
+        m_block.insert(m_block.end(), data, data + size);
+        data += size;
+        remaining -= size;
+        if(m_block.size() == block_size) SubmitBlock();
+    }
+    return count;
+}
+
+int BGZFStreamBuf::sync() {
+    // Only write the completed blocks, since flushing partial blocks would reduce the compression
+    while(!m_pending.empty()
+          && m_pending.front().wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        WriteBlock();
+    m_file.flush();
+    return m_file.good() ? 0 : -1;
+}
+
+void BGZFStreamBuf::SubmitBlock() {
+    if(m_threads.empty()) throw std::runtime_error("BGZFStream: Writing to a closed file");
+
+    Job job;
+    job.data.swap(m_block);
+    m_block.reserve(block_size);
+    m_pending.push_back(job.result.get_future());
+    m_jobs.Push(std::move(job));
+
+    // Wait for the oldest block once enough blocks are in flight
+    while(m_pending.size() > m_max_pending) WriteBlock();
+}
+
+void BGZFStreamBuf::WriteBlock() {
+    const auto block = m_pending.front().get();
+    m_pending.pop_front();
+    m_file.write(block.data(), static_cast<std::streamsize>(block.size()));
+    if(m_file.fail()) throw std::runtime_error("BGZFStream: Failed to write the file");
+}
+
+void BGZFStreamBuf::Compress() {
+    Job job;
+    while(m_jobs.Pop(job)) {
+        try {
+            job.result.set_value(CompressBlock(job.data, m_level));
+        } catch(...) {
+            job.result.set_exception(std::current_exception());
+        }
+    }
+}
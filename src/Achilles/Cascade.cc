@@ -153,6 +153,19 @@ std::size_t Cascade::GetInter(Particles &particles, const Particle &kickedPart,
 void Cascade::Reset() {
     kickedIdxs.resize(0);
     integrators.clear();
+    m_grid.Clear();
+}
+
+void Cascade::BuildGrid(const Particles &particles) {
+    if(m_search == SearchMode::Grid) m_grid.Build(particles);
+}
+
+InteractionDistances Cascade::InteractionCandidates(Particles particles, std::size_t idx) {
+    timeStep = distance/(particles[idx].Beta().Magnitude()*Constant::HBARC);
+    BuildGrid(particles);
+    auto results = AllowedInteractions(particles, idx);
+    m_grid.Clear();
+    return results;
 }
 
 void Cascade::Evolve(achilles::Event *event, const std::size_t &maxSteps) {
@@ -182,6 +195,7 @@ void Cascade::Evolve(std::shared_ptr<Nucleus> nucleus, const std::size_t& maxSte
         }
     }
     kickedIdxs = notCaptured;
+    BuildGrid(particles);
 
     for(std::size_t step = 0; step < maxSteps; ++step) {
         // Stop loop if no particles are propagating
@@ -224,6 +238,8 @@ void Cascade::Evolve(std::shared_ptr<Nucleus> nucleus, const std::size_t& maxSte
             UpdateIntegrator(idx, kickNuc);
 
             if(hit) {
+                // Hit nucleon is no longer part of the background
+                m_grid.Remove(hitIdx);
                 if(m_potential_prop
                    && localNucleus -> GetPotential() -> Hamiltonian(kickNuc -> Momentum().P(),
                                                                     kickNuc -> Position().P()) < Constant::mN) {
@@ -416,6 +432,7 @@ void Cascade::MeanFreePath(std::shared_ptr<Nucleus> nucleus, const std::size_t&
 
     // Initialize symplectic integrator
     AddIntegrator(idx, particles[idx]);
+    BuildGrid(particles);
 
     if (kickNuc -> Status() != ParticleStatus::internal_test) {
         throw std::runtime_error(
@@ -528,8 +545,12 @@ void Cascade::Escaped(Particles &particles) {
         const double energy = particle -> Momentum().E() - Constant::mN - potential;
         if(particle -> Position().Magnitude2() > pow(radius, 2)
            && particle -> Status() != ParticleStatus::external_test) {
-            if(energy > 0) particle -> Status() = ParticleStatus::final_state;
-            else particle -> Status() = ParticleStatus::background;
+            if(energy > 0) {
+                particle -> Status() = ParticleStatus::final_state;
+            } else {
+                particle -> Status() = ParticleStatus::background;
+                if(m_search == SearchMode::Grid) m_grid.Insert(*it, particle -> Position());
+            }
             it = kickedIdxs.erase(it);
         } else if(particle -> Status() == ParticleStatus::external_test
                   && particle -> Position().Pz() > radius) {
@@ -589,8 +610,12 @@ const ThreeVector Cascade::Project(const ThreeVector& position,
 ///      x---->  |
 ///      |       |   B 
 ///  C   |       |
+///
+/// In the Grid search mode only the background nucleons stored in the spatial grid
+/// near the cylinder of radius "m_searchRadius" around the path are tested, and
+/// nucleons with a larger impact parameter are discarded.
 const InteractionDistances Cascade::AllowedInteractions(Particles& particles,
-                                                        const std::size_t& idx) const noexcept {
+                                                        const std::size_t& idx) noexcept {
     InteractionDistances results;
 
     // Build planes
@@ -600,6 +625,25 @@ const InteractionDistances Cascade::AllowedInteractions(Particles& particles,
     auto normedMomentum = particles[idx].Momentum().Vec3().Unit();
     auto distance2 = (point2-point1).Dot(normedMomentum);
 
+    if(m_search == SearchMode::Grid) {
+        const double radius2 = m_searchRadius*m_searchRadius;
+        m_grid.Query(point1, point2, m_searchRadius, m_candidates);
+        // Keep the index order of the brute force search for reproducibility
+        std::sort(m_candidates.begin(), m_candidates.end());
+        for(auto i : m_candidates) {
+            if(particles[i].Status() != ParticleStatus::background) continue;
+            if(!BetweenPlanes(particles[i].Position(), point1, normedMomentum, distance2)) continue;
+            auto projectedPosition = Project(particles[i].Position(), point1, normedMomentum);
+            double dist2 = (projectedPosition - point1).Magnitude2();
+            if(dist2 > radius2) continue;
+
+            results.push_back(std::make_pair(i, dist2));
+        }
+
+        std::sort(results.begin(), results.end(), sortPairSecond);
+        return results;
+    }
+
     // Build results vector
     for(std::size_t i = 0; i < particles.size(); ++i) {
         // TODO: Should particles propagating be able to interact with
@@ -1,7 +1,8 @@
 #include "Achilles/CombinedCuts.hh"
 #include "Achilles/Particle.hh"
+#include "Achilles/ParticleView.hh"
 
-bool achilles::CutCollection::EvaluateCuts(const std::vector<achilles::Particle> &parts) {
+bool achilles::CutCollection::EvaluateCuts(const achilles::ParticleView &parts) {
     ntot++;
     bool result = true;
     spdlog::trace("Evaluating Cuts");
@@ -26,6 +27,10 @@ bool achilles::CutCollection::EvaluateCuts(const std::vector<achilles::Particle>
     return result;
 }
 
+bool achilles::CutCollection::EvaluateCuts(const std::vector<achilles::Particle> &parts) {
+    return EvaluateCuts(ParticleView(parts));
+}
+
 double achilles::CutCollection::CutEfficiency() const {
     return static_cast<double>(npass)/static_cast<double>(ntot);
 }
@@ -54,36 +54,41 @@ achilles::DensityConfiguration::DensityConfiguration(const std::string &filename
     }
 
     configs.close();
+
+    // Sample configurations according to their weights
+    std::vector<double> weights;
+    weights.reserve(m_configurations.size());
+    for(const auto &config : m_configurations) weights.push_back(config.wgt);
+    m_sampler.Build(weights);
 }
 
 std::vector<achilles::Particle> achilles::DensityConfiguration::GetConfiguration() {
-#ifdef ACHILLES_LOW_MEMORY
     std::vector<achilles::Particle> particles;
-#endif
-    while(true) {
-        auto index = Random::Instance().Uniform<std::size_t>(0, m_configurations.size());
+    FillConfiguration(particles);
+    return particles;
+}
 
-        if(m_configurations[index].wgt/m_maxWgt > Random::Instance().Uniform(0.0, 1.0)) {
-            Configuration &config = m_configurations[index];
-            std::array<double, 3> angles{};
-            Random::Instance().Generate(angles, 0.0, 2*M_PI);
-            angles[1] /= 2;
+void achilles::DensityConfiguration::FillConfiguration(std::vector<achilles::Particle> &particles) {
+    // The stored configurations are never modified, such that the density can be shared
+    // between the nuclei of different events and threads
+    auto index = Random::Instance().SelectIndex(m_sampler);
+    const Configuration &config = m_configurations[index];
+    std::array<double, 3> angles{};
+    Random::Instance().Generate(angles, 0.0, 2*M_PI);
+    angles[1] /= 2;
 
+    particles.resize(config.nucleons.size());
 #ifdef ACHILLES_LOW_MEMORY
-            for(auto& part : config.nucleons) {
-                const auto pid = part.is_proton ? PID::proton() : PID::neutron();
-                const auto position = ThreeVector(part.position).Rotate(angles);
-                particles.emplace_back(pid, FourVector{}, position);
-            }
-
-            return particles;
+    for(size_t i = 0; i < config.nucleons.size(); ++i) {
+        const auto &part = config.nucleons[i];
+        const auto pid = part.is_proton ? PID::proton() : PID::neutron();
+        const auto position = ThreeVector(part.position).Rotate(angles);
+        particles[i] = Particle(pid, FourVector{}, position);
+    }
 #else
-            for(auto& part : config.nucleons) {
-                part.SetPosition(part.Position().Rotate(angles));
-            }
-
-            return config.nucleons;
-#endif
-        }
+    for(size_t i = 0; i < config.nucleons.size(); ++i) {
+        particles[i] = config.nucleons[i];
+        particles[i].SetPosition(particles[i].Position().Rotate(angles));
     }
+#endif
 }
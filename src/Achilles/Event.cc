@@ -13,6 +13,21 @@ Event::Event(std::shared_ptr<Nucleus> nuc,
     m_me.resize(m_nuc -> NNucleons());
 }
 
+void Event::Reset(const std::vector<FourVector> &mom, double vwgt) {
+    m_type = HardScatteringType::None;
+    m_remnant = NuclearRemnant{};
+    m_mom.assign(mom.begin(), mom.end());
+    m_vWgt = vwgt;
+    m_meWgt = 0;
+    m_wgt = -1;
+    flux = 0;
+    m_leptons.clear();
+    m_history.Reset();
+
+    m_nuc -> GenerateConfig();
+    m_me.assign(m_nuc -> NNucleons(), 0);
+}
+
 // bool Event::ValidateEvent(size_t imatrix) const {
 //     spdlog::trace("Number of momentums = {}", m_mom.size());
 //     spdlog::trace("Number of states = {}", m_me[imatrix].inital_state.size() + m_me[imatrix].final_state.size());
@@ -77,11 +92,24 @@ void Event::Finalize() {
     m_remnant = NuclearRemnant(nA, nZ);
 }
 
+Event Event::Detach() const {
+    Event copy;
+    copy.CopyFrom(*this);
+    return copy;
+}
+
+void Event::CopyFrom(const Event &other) {
+    if(this == &other) return;
+    // Copy assigning the members keeps the capacity of their storage
+    auto nuc = std::move(m_nuc);
+    *this = other;
+    if(!other.m_nuc) return;
+    m_nuc = nuc ? std::move(nuc) : std::make_shared<Nucleus>();
+    m_nuc -> Nucleons() = other.m_nuc -> Nucleons();
+}
+
 achilles::vParticles Event::Particles() const {
-    vParticles result;
-    result.insert(result.end(), Hadrons().begin(), Hadrons().end());
-    result.insert(result.end(), m_leptons.begin(), m_leptons.end());
-    return result;
+    return ParticlesView().ToVector();
 }
 
 const achilles::vParticles& Event::Hadrons() const {
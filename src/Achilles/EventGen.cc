@@ -1,6 +1,8 @@
 #include "Achilles/EventGen.hh"
+#include "Achilles/AllocationCounter.hh"
 #include "Achilles/Event.hh"
 #include "Achilles/EventWriter.hh"
+#include "Achilles/HDF5Writer.hh"
 #include "Achilles/HardScatteringFactory.hh"
 #include "Achilles/HardScattering.hh"
 #include "Achilles/Nucleus.hh"
@@ -13,6 +15,7 @@
 #include "Achilles/ComplexFmt.hh"
 #include "Achilles/Units.hh"
 #include "Achilles/Channels.hh"
+#include "Achilles/BoundedQueue.hh"
 
 #ifdef ENABLE_BSM
 #include "plugins/Sherpa/SherpaInterface.hh"
@@ -25,6 +28,84 @@
 
 #include "yaml-cpp/yaml.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <thread>
+
+namespace {
+
+// Target accuracy of the integrator training, read from the same path that is hashed
+constexpr std::string_view accuracy_option = "Initialize/Accuracy";
+
+// Checkpoints with the extension .bin use the binary format instead of YAML
+bool IsBinary(const std::string &filename) {
+    static constexpr std::string_view extension = ".bin";
+    return filename.size() >= extension.size()
+        && filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+using Clock = std::chrono::steady_clock;
+
+// Substream of the random numbers of an event used by the cascade, following the phase space
+// and the hard scattering
+constexpr uint32_t cascade_substream = 2;
+
+// Add the primary vertex of the history, entered by the particles leaving the target and beam
+void AddPrimaryVertex(achilles::Event &event, const achilles::ThreeVector &position,
+                      size_t had_id, size_t lep_id) {
+    auto &history = event.History();
+    std::vector<size_t> final;
+    for(const auto &part : event.FinalParticlesView()) final.push_back(history.AddParticle(part));
+    history.AddVertexByIds(position, {had_id, lep_id}, final,
+                           achilles::EventHistory::StatusCode::primary);
+}
+
+}
+
+struct achilles::EventGen::Pipeline {
+    // An accepted event, with the number of events rejected by the worker before it and the
+    // number of the event selecting its random numbers
+    struct Item {
+        std::unique_ptr<Event> event;
+        size_t ntrials{}, worker{};
+        uint64_t number{};
+    };
+
+    // Number of events processed by a stage and the time spent summed over its threads
+    struct Stage {
+        std::atomic<size_t> nevents{};
+        std::atomic<int64_t> busy{};
+
+        void Add(Clock::duration time, size_t n=1) {
+            nevents += n;
+            busy += std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+        }
+        // Events per second on a single thread
+        double Throughput() const {
+            return busy == 0 ? 0 : static_cast<double>(nevents) / (static_cast<double>(busy) * 1e-9);
+        }
+    };
+
+    explicit Pipeline(size_t queue_size) : cascade_queue{queue_size}, output_queue{queue_size} {}
+
+    // Wake up all stages, e.g. after a stage failed
+    void Stop() {
+        cascade_queue.Close();
+        output_queue.Close();
+        for(auto &pool : events) pool -> Close();
+    }
+
+    BoundedQueue<Item> cascade_queue, output_queue;
+    // Events available to each worker, each owning a nucleus. An event is returned to the
+    // worker once it is written, and reused for a later event
+    std::vector<std::unique_ptr<BoundedQueue<std::unique_ptr<Event>>>> events;
+    Stage hard, cascade, output;
+    double wall_time{};
+};
+
 
 achilles::EventGen::EventGen(const std::string &configFile,
                              std::vector<std::string> shargs) : config{configFile} {
@@ -33,28 +114,131 @@ achilles::EventGen::EventGen(const std::string &configFile,
     runDecays = false;
 
     // Setup random number generator
-    auto seed = static_cast<unsigned int>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+    m_seed = static_cast<unsigned int>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
     if(config.Exists("Options/Initialize/Seed"))
         if(config.GetAs<int>("Options/Initialize/Seed") > 0)
-            seed = config.GetAs<unsigned int>("Options/Initialize/Seed");
-    spdlog::trace("Seeding generator with: {}", seed);
-    Random::Instance().Seed(seed);
+            m_seed = config.GetAs<unsigned int>("Options/Initialize/Seed");
+    if(config.Exists("Options/Initialize/Engine")) {
+        const auto engine = config.GetAs<std::string>("Options/Initialize/Engine");
+        if(engine == "Philox") {
+            Random::SetDefaultEngine(Random::Engine::Philox);
+        } else if(engine != "MersenneTwister") {
+            const std::string msg = fmt::format("EventGen: Invalid random number engine {}", engine);
+            throw std::runtime_error(msg);
+        }
+        spdlog::info("Using {} random number engine", engine);
+    }
+    spdlog::trace("Seeding generator with: {}", m_seed);
+    Random::Instance().Seed(m_seed);
+
+    // Setup the number of threads used for event generation
+    if(config.Exists("Main/Threads")) {
+        m_nthreads = config.GetAs<size_t>("Main/Threads");
+        if(m_nthreads == 0) m_nthreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+#ifdef ENABLE_BSM
+    if(m_nthreads > 1) {
+        spdlog::warn("EventGen: Sherpa is not thread safe, generating events on a single thread");
+        m_nthreads = 1;
+    }
+#endif
+    spdlog::info("Generating events with {} thread(s)", m_nthreads);
+
+    // Setup the pipelined event generation
+    if(config.Exists("Main/Pipeline")) {
+        m_cascade_threads = 1;
+        m_queue_size = 256;
+        if(config.Exists("Main/Pipeline/CascadeThreads"))
+            m_cascade_threads = std::max(config.GetAs<size_t>("Main/Pipeline/CascadeThreads"), size_t{1});
+        if(config.Exists("Main/Pipeline/QueueSize"))
+            m_queue_size = std::max(config.GetAs<size_t>("Main/Pipeline/QueueSize"), size_t{1});
+#ifdef ENABLE_BSM
+        spdlog::warn("EventGen: Sherpa is not thread safe, disabling the event pipeline");
+        m_cascade_threads = 0;
+#endif
+        if(m_cascade_threads > 0)
+            spdlog::info("Pipelining events with {} cascade thread(s) and queues of {} events",
+                         m_cascade_threads, m_queue_size);
+    }
 
     // Setup unweighter
     unweighter = UnweighterFactory::Initialize(config.GetAs<std::string>("Options/Unweighting/Name"),
                                                config["Options/Unweighting"]);
 
+    SetupPhysics(std::move(shargs));
+
+    // Setup Multichannel integrator
+    // auto params = config["Integration"]["Params"].as<MultiChannelParams>();
+    integrator = MultiChannel(integrand.NDims(), integrand.NChannels(), {1000, 2});
+    if(config.Exists("Options/Initialize/Stratifications"))
+        integrator.Parameters().nstrat = config.GetAs<size_t>("Options/Initialize/Stratifications");
+
+    // Setup outputs
+    bool zipped = true;
+    if(config.Exists("Main/Output/Zipped"))
+        zipped = config.GetAs<bool>("Main/Output/Zipped");
+    size_t compression_threads = 0;
+    if(config.Exists("Main/Output/CompressionThreads"))
+        compression_threads = config.GetAs<size_t>("Main/Output/CompressionThreads");
+    if(config.Exists("Main/Output/WriteRejected"))
+        writeRejected = config.GetAs<bool>("Main/Output/WriteRejected");
+    auto format = config.GetAs<std::string>("Main/Output/Format");
+    auto name = config.GetAs<std::string>("Main/Output/Name");
+    spdlog::trace("Outputing as {} format", format);
+    std::unique_ptr<EventWriter> output;
+    if(format == "Achilles") {
+        output = std::make_unique<AchillesWriter>(name, zipped, compression_threads);
+    } else if(format == "HDF5") {
+        size_t chunk_size = 65536;
+        if(config.Exists("Main/Output/ChunkSize"))
+            chunk_size = config.GetAs<size_t>("Main/Output/ChunkSize");
+        output = std::make_unique<HDF5Writer>(name, zipped, chunk_size);
+#ifdef ENABLE_HEPMC3
+    } else if(format == "HepMC3") {
+        output = std::make_unique<HepMC3Writer>(name, zipped, compression_threads);
+    } else if(format == "NuHepMC") {
+        output = std::make_unique<NuHepMCWriter>(name, zipped, compression_threads);
+#endif
+    } else {
+        std::string msg = fmt::format("Achilles: Invalid output format requested {}", format);
+        throw std::runtime_error(msg);
+    }
+    // Optionally write the events on a background thread
+    if(config.Exists("Main/Output/Async") && config.GetAs<bool>("Main/Output/Async")) {
+        size_t buffer_size = 1024;
+        if(config.Exists("Main/Output/BufferSize"))
+            buffer_size = std::max(config.GetAs<size_t>("Main/Output/BufferSize"), size_t{1});
+        writer = std::make_shared<AsyncWriter>(std::move(output), buffer_size);
+    } else {
+        writer = std::move(output);
+    }
+    writer -> WriteHeader(configFile);
+    writer_mutex = std::make_shared<std::mutex>();
+}
+
+achilles::EventGen::~EventGen() = default;
+
+achilles::EventGen::EventGen(const EventGen &master, size_t worker)
+    : runDecays{master.runDecays}, writeRejected{master.writeRejected}, m_seed{master.m_seed}, m_worker{worker},
+      nucleus{master.nucleus}, integrator{master.integrator}, config{master.config}, writer{master.writer},
+      writer_mutex{master.writer_mutex}, unweighter{master.unweighter -> Clone()} {
+    // Each worker owns its nucleus, cascade and hard scattering, since these are modified
+    // during the generation of an event. The nucleus is cloned from the one of the master, so
+    // the density configurations are shared. Workers are only created without BSM enabled
+    SetupPhysics({});
+
+    // Start from the optimized grids of the master
+    integrand.CopyGrids(master.integrand);
+    integrand.Function() = [this](const std::vector<FourVector> &mom, const double &wgt) {
+        return GenerateEvent(mom, wgt);
+    };
+}
+
+void achilles::EventGen::SetupPhysics(std::vector<std::string> shargs) {
     // Load initial state, massess
     spdlog::trace("Initializing the beams");
     beam = std::make_shared<Beam>(config.GetAs<Beam>("Beams"));
-    nucleus = std::make_shared<Nucleus>(config.GetAs<Nucleus>("Nucleus"));
-
-    // Set potential for the nucleus
-    auto potential_name = config.GetAs<std::string>("Nucleus/Potential/Name");
-    auto potential = achilles::PotentialFactory::Initialize(potential_name,
-                                                          nucleus,
-                                                          config["Nucleus/Potential"]);
-    nucleus -> SetPotential(std::move(potential));
+    nucleus = MakeNucleus();
     // Initialize Cascade parameters
     spdlog::debug("Cascade mode: {}", config.GetAs<bool>("Cascade/Run"));
     if(config.GetAs<bool>("Cascade/Run")) {
@@ -151,10 +335,6 @@ achilles::EventGen::EventGen(const std::string &configFile,
 #endif
     }
 
-    // Setup Multichannel integrator
-    // auto params = config["Integration"]["Params"].as<MultiChannelParams>();
-    integrator = MultiChannel(integrand.NDims(), integrand.NChannels(), {1000, 2});
-
     // Decide whether to rotate events to be measured w.r.t. the lepton plane
     if(config.Exists("Main/DoRotate"))
         doRotate = config.GetAs<bool>("Main/DoRotate");
@@ -170,66 +350,189 @@ achilles::EventGen::EventGen(const std::string &configFile,
     //     doEventCuts = config["Main"]["EventCuts"].as<bool>();
     // spdlog::info("Apply event cuts? {}", doEventCuts);
     // event_cuts = config["EventCuts"].as<achilles::CutCollection>();
+}
 
-    // Setup outputs
-    bool zipped = true;
-    if(config.Exists("Main/Output/Zipped"))
-        zipped = config.GetAs<bool>("Main/Output/Zipped");
-    auto format = config.GetAs<std::string>("Main/Output/Format");
-    auto name = config.GetAs<std::string>("Main/Output/Name");
-    spdlog::trace("Outputing as {} format", format);
-    if(format == "Achilles") {
-        writer = std::make_unique<AchillesWriter>(name, zipped);
-#ifdef ENABLE_HEPMC3
-    } else if(format == "HepMC3") {
-        writer = std::make_unique<HepMC3Writer>(name, zipped);
-    } else if(format == "NuHepMC") {
-        writer = std::make_unique<NuHepMCWriter>(name, zipped);
-#endif
-    } else {
-        std::string msg = fmt::format("Achilles: Invalid output format requested {}", format);
-        throw std::runtime_error(msg);
-    }
-    writer -> WriteHeader(configFile);
+std::shared_ptr<achilles::Nucleus> achilles::EventGen::MakeNucleus() const {
+    // Only load the density configurations for the first nucleus, and share them afterwards
+    auto result = nucleus ? nucleus -> Clone()
+                          : std::make_shared<Nucleus>(config.GetAs<Nucleus>("Nucleus"));
+
+    // Set potential for the nucleus
+    auto potential_name = config.GetAs<std::string>("Nucleus/Potential/Name");
+    auto potential = achilles::PotentialFactory::Initialize(potential_name,
+                                                          result,
+                                                          config["Nucleus/Potential"]);
+    result -> SetPotential(std::move(potential));
+    return result;
+}
+
+const std::vector<std::string_view> &achilles::EventGen::CheckpointOptions() {
+    static const std::vector<std::string_view> options = {
+        "Beams", "Nucleus", "Process", "NuclearModel", "HardCuts", "TestingPS", "Main/HardCuts",
+        "Options/Unweighting", accuracy_option, "Options/Initialize/Stratifications"
+    };
+    return options;
 }
 
 void achilles::EventGen::Initialize() {
-    // TODO: Clean up loading of previous results
-    auto func = [&](const std::vector<FourVector> &mom, const double &wgt) {
+    integrand.Function() = [&](const std::vector<FourVector> &mom, const double &wgt) {
         return GenerateEvent(mom, wgt);
     };
-    // TODO: Loading the saved data is broken
-    // try {
-    //     YAML::Node old_results = YAML::LoadFile("results.yml");
-    //     integrator = old_results["Multichannel"].as<MultiChannel>();
-    //     integrand = old_results["Channels"].as<Integrand<FourVector>>();
-    //     YAML::Node results;
-    //     results["Multichannel"] = integrator;
-    //     results["Channels"] = integrand;
-    //     integrand.Function() = func;
-    // } catch(const YAML::BadFile &e) {
-        spdlog::info("Initializing integrator.");
-        integrand.Function() = func;
-        if(config.Exists("Initialize/Accuracy"))
-            integrator.Parameters().rtol = config["Initialize"]["Accuracy"].as<double>();
+
+    // Reuse the integrator trained by a previous run with the same physics setup
+    std::string checkpoint = "results.yml";
+    if(config.Exists("Options/Initialize/Checkpoint"))
+        checkpoint = config.GetAs<std::string>("Options/Initialize/Checkpoint");
+    const uint64_t hash = config.Hash(CheckpointOptions());
+    if(LoadCheckpoint(checkpoint, hash)) {
+        spdlog::info("Loaded trained integrator from {}", checkpoint);
+        return;
+    }
+
+    spdlog::info("Initializing integrator.");
+    if(config.Exists(accuracy_option))
+        integrator.Parameters().rtol = config.GetAs<double>(accuracy_option);
+    if(m_nthreads > 1) {
+        // Each thread evaluates the integrand with the state of its own worker
+        std::vector<std::unique_ptr<EventGen>> workers;
+        std::vector<Integrand<FourVector>*> integrands{&integrand};
+        for(size_t i = 1; i < m_nthreads; ++i) {
+            workers.emplace_back(new EventGen(*this, i));
+            integrands.push_back(&workers.back() -> integrand);
+        }
+        integrator.Optimize(integrands);
+        for(const auto &worker : workers)
+            unweighter -> AddEvents(*worker -> unweighter);
+    } else {
         integrator.Optimize(integrand);
-        integrator.Summary();
+    }
+    integrator.Summary();
+
+    SaveCheckpoint(checkpoint, hash);
+}
 
-        YAML::Node results;
-        results["Multichannel"] = integrator;
-        results["Channels"] = integrand;
+bool achilles::EventGen::LoadCheckpoint(const std::string &filename, uint64_t hash) {
+    if(IsBinary(filename)) return LoadBinaryCheckpoint(filename, hash);
 
-        std::ofstream fresults("results.yml");
-        fresults << results;
-        fresults.close();
-    // }
+    YAML::Node results;
+    try {
+        results = YAML::LoadFile(filename);
+    } catch(const YAML::BadFile&) {
+        return false;
+    }
+
+    if(!results["Hash"] || results["Hash"].as<std::string>() != fmt::format("{:016x}", hash)) {
+        spdlog::info("Run card changed since {} was written, retraining the integrator", filename);
+        return false;
+    }
+
+    // Only replace the current state once everything is loaded successfully
+    try {
+        auto saved = results["Multichannel"].as<MultiChannel>();
+        auto saved_unweighter = unweighter -> Clone();
+        if(saved.NChannels() != integrand.NChannels()
+           || !saved_unweighter -> FromYAML(results["Unweighter"])
+           || !integrand.LoadIntegrators(results["Channels"])) {
+            spdlog::warn("EventGen: Checkpoint {} does not match the setup, retraining the integrator",
+                         filename);
+            return false;
+        }
+
+        integrator = std::move(saved);
+        unweighter = std::move(saved_unweighter);
+    } catch(const YAML::Exception &e) {
+        spdlog::warn("EventGen: Failed to load checkpoint {} ({}), retraining the integrator",
+                     filename, e.what());
+        return false;
+    }
+
+    return true;
+}
+
+void achilles::EventGen::SaveCheckpoint(const std::string &filename, uint64_t hash) const {
+    if(IsBinary(filename)) return SaveBinaryCheckpoint(filename, hash);
+
+    YAML::Node results;
+    results["Hash"] = fmt::format("{:016x}", hash);
+    results["Multichannel"] = integrator;
+    results["Channels"] = integrand;
+    results["Unweighter"] = unweighter -> ToYAML();
+
+    // Write to a temporary file first, so an interrupted run can not leave a partial checkpoint
+    const std::string tmp = filename + ".tmp";
+    std::ofstream fresults(tmp);
+    fresults << results;
+    fresults.close();
+    if(!fresults || std::rename(tmp.c_str(), filename.c_str()) != 0)
+        spdlog::warn("EventGen: Failed to write checkpoint {}", filename);
+}
+
+bool achilles::EventGen::LoadBinaryCheckpoint(const std::string &filename, uint64_t hash) {
+    std::vector<char> data;
+    try {
+        data = BinaryReader::ReadFile(filename);
+    } catch(const std::runtime_error&) {
+        return false;
+    }
+
+    // Only replace the current state once everything is loaded successfully
+    try {
+        BinaryReader in(data);
+        if(in.Get<uint64_t>() != hash) {
+            spdlog::info("Run card changed since {} was written, retraining the integrator", filename);
+            return false;
+        }
+
+        MultiChannel saved;
+        auto saved_unweighter = unweighter -> Clone();
+        if(!in.Read(saved) || saved.NChannels() != integrand.NChannels()
+           || !saved_unweighter -> FromYAML(YAML::Load(in.Get<std::string>()))
+           || !in.Read(integrand)) {
+            spdlog::warn("EventGen: Checkpoint {} does not match the setup, retraining the integrator",
+                         filename);
+            return false;
+        }
+
+        integrator = std::move(saved);
+        unweighter = std::move(saved_unweighter);
+    } catch(const std::exception &e) {
+        spdlog::warn("EventGen: Failed to load checkpoint {} ({}), retraining the integrator",
+                     filename, e.what());
+        return false;
+    }
+
+    return true;
+}
+
+void achilles::EventGen::SaveBinaryCheckpoint(const std::string &filename, uint64_t hash) const {
+    // Write to a temporary file first, so an interrupted run can not leave a partial checkpoint
+    const std::string tmp = filename + ".tmp";
+    std::ofstream fresults(tmp, std::ios::binary);
+    BinaryWriter out(fresults);
+    out.Write(hash);
+    out.Write(integrator);
+    out.Write(YAML::Dump(unweighter -> ToYAML()));
+    out.Write(integrand);
+    fresults.close();
+    if(!fresults || std::rename(tmp.c_str(), filename.c_str()) != 0)
+        spdlog::warn("EventGen: Failed to write checkpoint {}", filename);
 }
 
 void achilles::EventGen::GenerateEvents() {
     outputEvents = true;
     runCascade = config["Cascade/Run"].as<bool>();
-    integrator.Parameters().ncalls = config["Main/NEvents"].as<size_t>();
-    integrator(integrand);
+    m_nevents = config["Main/NEvents"].as<size_t>();
+    if(m_cascade_threads > 0) {
+        GenerateEventsPipelined();
+    } else if(m_nthreads > 1) {
+        GenerateEventsThreaded();
+    } else {
+        integrator.Generate(integrand, [this]() { return unweighter->Accepted() >= m_nevents; });
+        writer -> AddTrials(m_ntrials);
+        m_ntrials = 0;
+    }
+    writer -> WriteFooter();
+    writer -> Flush();
     fmt::print("\n");
     auto result = integrator.Summary();
     fmt::print("Integral = {:^8.5e} +/- {:^8.5e} ({:^8.5e} %)\n",
@@ -237,20 +540,224 @@ void achilles::EventGen::GenerateEvents() {
                result.results.back().Error() / result.results.back().Mean()*100);
     fmt::print("Unweighting efficiency: {:^8.5e} %\n",
                unweighter->Efficiency() * 100);
+    if(unweighter->MaxWeight() > 0)
+        fmt::print("Maximum weight: {:^8.5e} +/- {:^8.5e}\n",
+                   unweighter->MaxWeight(), unweighter->MaxWeightError());
+    if(runCascade && m_nunweight > 0)
+        fmt::print("Cascade evaluations: {} of {} events passing the cuts ({:^8.5e} % saved)\n",
+                   m_ncascade, m_nunweight,
+                   static_cast<double>(m_nunweight - m_ncascade) / static_cast<double>(m_nunweight) * 100);
+    if(AllocationCounter::Enabled())
+        fmt::print("Event setup: {} heap allocations in {} events\n", m_nreset_allocs, m_nreset);
+    if(m_pipeline) PrintPipeline();
+}
+
+void achilles::EventGen::GenerateEventsThreaded() {
+    auto workers = MakeWorkers();
+    RunWorkers(workers);
+    MergeWorkers(workers);
+}
+
+std::vector<std::unique_ptr<achilles::EventGen>> achilles::EventGen::MakeWorkers() const {
+    // Setup the workers serially, splitting the requested events evenly
+    std::vector<std::unique_ptr<EventGen>> workers;
+    for(size_t i = 0; i < m_nthreads; ++i) {
+        workers.emplace_back(new EventGen(*this, i));
+        auto &worker = *workers.back();
+        worker.outputEvents = outputEvents;
+        worker.runCascade = runCascade;
+        worker.m_nevents = m_nevents / m_nthreads + (i < m_nevents % m_nthreads ? 1 : 0);
+    }
+    return workers;
+}
+
+void achilles::EventGen::RunWorkers(std::vector<std::unique_ptr<EventGen>> &workers) const {
+    // Each worker uses its own random number stream derived from the master seed, such that
+    // the results are reproducible for a fixed seed and number of threads. The workers sample
+    // interleaved events following the training, so no event is sampled twice
+    for(size_t i = 0; i < workers.size(); ++i)
+        workers[i] -> integrator.SetEvents(integrator.NextEvent() + i, workers.size());
+    std::vector<std::thread> threads;
+    std::vector<std::exception_ptr> errors(workers.size());
+    for(size_t i = 0; i < workers.size(); ++i) {
+        threads.emplace_back([this, &workers, &errors, i]() {
+            try {
+                Random::Instance().Seed(m_seed, static_cast<unsigned int>(i + 1));
+                auto &worker = *workers[i];
+                worker.integrator.Generate(worker.integrand, [&worker]() {
+                    return worker.unweighter->Accepted() >= worker.m_nevents;
+                });
+            } catch(...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+    for(auto &thread : threads) thread.join();
+    for(const auto &error : errors)
+        if(error) std::rethrow_exception(error);
+}
+
+void achilles::EventGen::MergeWorkers(const std::vector<std::unique_ptr<EventGen>> &workers) {
+    // Reduce the results in a fixed order
+    std::vector<MultiChannel> results;
+    for(const auto &worker : workers) {
+        results.push_back(worker -> integrator);
+        unweighter -> Merge(*worker -> unweighter);
+        m_nunweight += worker -> m_nunweight;
+        m_ncascade += worker -> m_ncascade;
+        m_nreset += worker -> m_nreset;
+        m_nreset_allocs += worker -> m_nreset_allocs;
+        writer -> AddTrials(worker -> m_ntrials);
+    }
+    integrator.MergeIterations(results);
+}
+
+void achilles::EventGen::GenerateEventsPipelined() {
+    auto workers = MakeWorkers();
+    m_pipeline = std::make_shared<Pipeline>(m_queue_size);
+
+    // Each event in flight owns a nucleus, sharing the density configurations of the master.
+    // Give every worker enough events to fill the queues, beyond which the workers wait for
+    // events to be written
+    const size_t in_flight = m_pipeline -> cascade_queue.Capacity()
+                           + m_pipeline -> output_queue.Capacity() + m_cascade_threads + 1;
+    const size_t pool_size = in_flight / m_nthreads + 2;
+    for(auto &worker : workers) {
+        auto pool = std::make_unique<BoundedQueue<std::unique_ptr<Event>>>(pool_size);
+        pool -> Push(std::make_unique<Event>(worker -> nucleus));
+        for(size_t i = 1; i < pool_size; ++i) pool -> Push(std::make_unique<Event>(MakeNucleus()));
+        m_pipeline -> events.push_back(std::move(pool));
+        worker -> m_pipeline = m_pipeline;
+    }
+    std::vector<std::unique_ptr<Cascade>> cascades;
+    for(size_t i = 0; i < m_cascade_threads && runCascade; ++i)
+        cascades.push_back(std::make_unique<Cascade>(config.GetAs<Cascade>("Cascade")));
+
+    // Events are not assigned to the cascade threads in a reproducible order. Counter-based
+    // engines continue with the random numbers of the event, such that the cascade gives the
+    // same result as on the worker, while the Mersenne twister uses a stream per thread
+    std::vector<std::thread> threads;
+    std::vector<std::exception_ptr> errors(m_cascade_threads + 1);
+    for(size_t i = 0; i < m_cascade_threads; ++i) {
+        threads.emplace_back([this, &cascades, &errors, i]() {
+            try {
+                Random::Instance().Seed(m_seed, static_cast<unsigned int>(m_nthreads + i + 1));
+                Pipeline::Item item;
+                while(m_pipeline -> cascade_queue.Pop(item)) {
+                    const auto begin = Clock::now();
+                    Random::Instance().SetEvent(item.number, cascade_substream);
+                    FinishEvent(*item.event, runCascade ? cascades[i].get() : nullptr);
+                    m_pipeline -> cascade.Add(Clock::now() - begin);
+                    if(!m_pipeline -> output_queue.Push(std::move(item))) break;
+                }
+            } catch(...) {
+                errors[i] = std::current_exception();
+                m_pipeline -> Stop();
+            }
+        });
+    }
+    threads.emplace_back([this, &errors]() {
+        try {
+            Pipeline::Item item;
+            while(m_pipeline -> output_queue.Pop(item)) {
+                const auto begin = Clock::now();
+                {
+                    std::lock_guard<std::mutex> lock(*writer_mutex);
+                    writer -> AddTrials(item.ntrials);
+                    writer -> Write(*item.event);
+                }
+                m_pipeline -> output.Add(Clock::now() - begin);
+
+                // Return the event to the worker that generated it
+                m_pipeline -> events[item.worker] -> Push(std::move(item.event));
+            }
+        } catch(...) {
+            errors.back() = std::current_exception();
+            m_pipeline -> Stop();
+        }
+    });
+
+    // Run the workers, and drain the stages in order once they finish
+    const auto begin = Clock::now();
+    std::exception_ptr worker_error;
+    try {
+        RunWorkers(workers);
+    } catch(...) {
+        worker_error = std::current_exception();
+        m_pipeline -> Stop();
+    }
+    m_pipeline -> cascade_queue.Close();
+    for(size_t i = 0; i < m_cascade_threads; ++i) threads[i].join();
+    m_pipeline -> output_queue.Close();
+    threads.back().join();
+    m_pipeline -> wall_time = std::chrono::duration<double>(Clock::now() - begin).count();
+
+    // Report the failure of a stage before the workers it stopped
+    for(const auto &error : errors)
+        if(error) std::rethrow_exception(error);
+    if(worker_error) std::rethrow_exception(worker_error);
+
+    MergeWorkers(workers);
+    if(runCascade) m_ncascade += m_pipeline -> cascade.nevents;
+}
+
+void achilles::EventGen::PrintPipeline() const {
+    fmt::print("Pipeline ({:.2f} s, {:^8.5e} events / s):\n", m_pipeline -> wall_time,
+               static_cast<double>(m_pipeline -> output.nevents) / m_pipeline -> wall_time);
+    fmt::print("  {:<16} {:>10} events, {:^8.5e} events / s / thread ({} threads)\n", "Hard scattering:",
+               m_pipeline -> hard.nevents.load(), m_pipeline -> hard.Throughput(), m_nthreads);
+    const auto print_stage = [](const std::string &name, const Pipeline::Stage &stage,
+                                const BoundedQueue<Pipeline::Item> &queue, size_t nthreads) {
+        fmt::print("  {:<16} {:>10} events, {:^8.5e} events / s / thread ({} threads), "
+                   "queue depth {:.1f} average / {} max / {} capacity\n",
+                   name, stage.nevents.load(), stage.Throughput(), nthreads,
+                   queue.MeanDepth(), queue.MaxDepth(), queue.Capacity());
+    };
+    print_stage("Cascade:", m_pipeline -> cascade, m_pipeline -> cascade_queue, m_cascade_threads);
+    print_stage("Output:", m_pipeline -> output, m_pipeline -> output_queue, 1);
 }
 
 double achilles::EventGen::GenerateEvent(const std::vector<FourVector> &mom, const double &wgt) {
-    if(outputEvents) {
+    if(!m_pipeline) return EvaluateEvent(mom, wgt);
+
+    // Each event in flight owns a nucleus, and is taken from the pool of the worker
+    if(!m_event && !m_pipeline -> events[m_worker] -> Pop(m_event))
+        throw std::runtime_error("EventGen: The event pipeline was stopped");
+
+    // Time the hard scattering without the waits on the queues, as for the other stages
+    const size_t accepted = unweighter -> Accepted();
+    const auto begin = Clock::now();
+    const double weight = EvaluateEvent(mom, wgt);
+    const bool handover = unweighter -> Accepted() > accepted;
+    m_pipeline -> hard.Add(Clock::now() - begin, handover ? 1 : 0);
+    if(!handover) return weight;
+
+    // Hand the event over to the cascade stage, together with the events rejected before it
+    if(!m_pipeline -> cascade_queue.Push({std::move(m_event), m_ntrials, m_worker,
+                                          Random::Instance().CurrentEvent()}))
+        throw std::runtime_error("EventGen: The event pipeline was stopped");
+    m_ntrials = 0;
+    return weight;
+}
+
+double achilles::EventGen::EvaluateEvent(const std::vector<FourVector> &mom, const double &wgt) {
+    if(outputEvents && m_worker == 0) {
         static constexpr size_t statusUpdate = 1000;
         if(unweighter->Accepted() % statusUpdate == 0) {
             fmt::print("Generated {} / {} events\r",
-                       unweighter->Accepted(),
-                       config["Main/NEvents"].as<size_t>());
+                       unweighter->Accepted(), m_nevents);
         }
     }
+    // Reuse the event of the worker
+    if(!m_event) m_event = std::make_unique<Event>(nucleus);
+
     // Initialize the event, which generates the nuclear configuration
     // and initializes the beam particle for the event
-    Event event(nucleus, mom, wgt);
+    const size_t nallocs = AllocationCounter::Count();
+    m_event -> Reset(mom, wgt);
+    m_nreset++;
+    m_nreset_allocs += AllocationCounter::Count() - nallocs;
+    Event &event = *m_event;
 
     // Initialize the particle ids for the processes
     const auto pids = scattering -> Process().m_ids;
@@ -276,12 +783,7 @@ double achilles::EventGen::GenerateEvent(const std::vector<FourVector> &mom, con
         if(outputEvents) {
             event.SetMEWeight(0);
             event.CalcWeight();
-            spdlog::trace("Outputting the event");
-            writer -> Write(event);
-
-            // Update number of calls needed to ensure the number of generated events
-            // is the same as that requested by the user
-            integrator.Parameters().ncalls++;
+            RejectEvent(event);
         }
 
 #ifdef ENABLE_BSM
@@ -317,10 +819,7 @@ double achilles::EventGen::GenerateEvent(const std::vector<FourVector> &mom, con
             if(outputEvents) {
                 event.SetMEWeight(0);
                 event.CalcWeight();
-                writer -> Write(event);
-                // Update number of calls needed to ensure the number of generated events
-                // is the same as that requested by the user
-                integrator.Parameters().ncalls++;
+                RejectEvent(event);
             }
 
 #ifdef ENABLE_BSM
@@ -330,12 +829,51 @@ double achilles::EventGen::GenerateEvent(const std::vector<FourVector> &mom, con
         }
     }
 
-    // TODO: Move to after unweighting?
+    // During the optimization only the hard-scattering weight is needed
+    if(!outputEvents) {
+        unweighter->AddEvent(event);
+#ifdef ENABLE_BSM
+        p_sherpa->Reset();
+#endif
+        return event.Weight();
+    }
+
+    // Unweight on the hard-scattering weight before running the cascade. The cascade does not
+    // change the weight of the event, so the accepted events are distributed identically, and
+    // the cascade is only evaluated for the events that are written out
+    m_nunweight++;
+    if(!unweighter->AcceptEvent(event)) {
+        RejectEvent(event);
+#ifdef ENABLE_BSM
+        p_sherpa->Reset();
+#endif
+        return event.Weight();
+    }
+
+    // The pipeline runs the cascade on another stage
+    if(m_pipeline) return event.Weight();
+
+    Random::Instance().SetEvent(Random::Instance().CurrentEvent(), cascade_substream);
+    FinishEvent(event, cascade.get());
+    if(runCascade) m_ncascade++;
+    WriteEvent(event);
+
+#ifdef ENABLE_BSM
+    p_sherpa->Reset();
+#endif
+
+    // Always return the weight when the event passes the initial hard cut.
+    // Even if events do not survive the final event-level cuts, Vegas should
+    // still interpret the integrand as nonzero in this region.
+    return event.Weight();
+}
+
+void achilles::EventGen::FinishEvent(Event &event, Cascade *event_cascade) const {
     // Run the cascade if needed
     if(runCascade) {
 #ifdef ACHILLES_EVENT_DETAILS
         spdlog::trace("Hadrons:");
-        idx = 0;
+        size_t idx = 0;
         for(const auto &particle : event.Hadrons()) {
             if(particle.Status() == ParticleStatus::initial_state
                 && particle.ID() == PID::proton())
@@ -344,7 +882,7 @@ double achilles::EventGen::GenerateEvent(const std::vector<FourVector> &mom, con
         }
 #endif
         spdlog::trace("Runnning cascade");
-        cascade -> Evolve(&event);
+        event_cascade -> Evolve(&event);
 
 #ifdef ACHILLES_EVENT_DETAILS
         spdlog::trace("Hadrons (Post Cascade):");
@@ -362,102 +900,85 @@ double achilles::EventGen::GenerateEvent(const std::vector<FourVector> &mom, con
     }
 
     // Write out events
-    if(outputEvents) {
-        // TODO: Handle MEC case
-        // Setup target nucleus in history
-        auto init_nuc = event.CurrentNucleus()->InitParticle();
-        Particle init_had;
-        for(const auto &nucleon : event.CurrentNucleus()->Nucleons()) {
-            if(nucleon.Status() == ParticleStatus::initial_state) {
-                init_had = nucleon;
-                break;
-            }
+    // TODO: Handle MEC case
+    // Setup target nucleus in history
+    auto init_nuc = event.CurrentNucleus()->InitParticle();
+    Particle init_had;
+    for(const auto &nucleon : event.CurrentNucleus()->Nucleons()) {
+        if(nucleon.Status() == ParticleStatus::initial_state) {
+            init_had = nucleon;
+            break;
         }
-        event.History().AddVertex(init_had.Position(), {init_nuc}, {init_had}, EventHistory::StatusCode::target);
-        // Setup beam in history
-        auto init_lep = event.Leptons()[0];
-        auto init_beam = init_lep;
-        init_beam.Status() = ParticleStatus::beam;
-        const double max_energy = beam->MaxEnergy();
-        init_beam.Momentum() = {max_energy, 0, 0, max_energy};
-        event.History().AddVertex({}, {init_beam}, {init_lep}, EventHistory::StatusCode::beam);
+    }
+    // The particles are added once, and the vertices refer to them by index
+    auto &history = event.History();
+    const size_t nuc_id = history.AddParticle(init_nuc);
+    const size_t had_id = history.AddParticle(init_had);
+    history.AddVertexByIds(init_had.Position(), {nuc_id}, {had_id}, EventHistory::StatusCode::target);
+    // Setup beam in history
+    auto init_lep = event.Leptons()[0];
+    auto init_beam = init_lep;
+    init_beam.Status() = ParticleStatus::beam;
+    const double max_energy = beam->MaxEnergy();
+    init_beam.Momentum() = {max_energy, 0, 0, max_energy};
+    const size_t beam_id = history.AddParticle(init_beam);
+    const size_t lep_id = history.AddParticle(init_lep);
+    history.AddVertexByIds({}, {beam_id}, {lep_id}, EventHistory::StatusCode::beam);
 #ifdef ENABLE_BSM
-        // Running Sherpa interface if requested
-        // Only needed when generating events and not optimizing the multichannel
-        // TODO: Move to after unweighting?
-        if(event.Weight() > 0) {
-            if(runDecays)
-                p_sherpa -> GenerateEvent(event);
-            else {
-                // TODO: Properly build history including the cascade
-                std::vector<Particle> final;
-                for(const auto &part : event.Particles()) {
-                    if(part.IsFinal()) final.push_back(part);
-                }
-                event.History().AddVertex(init_had.Position(), {init_had, init_lep}, {final},
-                                          EventHistory::StatusCode::primary); 
-            }
-        }
+    // Running Sherpa interface if requested
+    // Only needed when generating events and not optimizing the multichannel
+    if(runDecays)
+        p_sherpa -> GenerateEvent(event);
+    else {
+        // TODO: Properly build history including the cascade
+        AddPrimaryVertex(event, init_had.Position(), had_id, lep_id);
+    }
 #else
-        if(event.Weight() > 0) {
-            // TODO: Properly build history including the cascade
-            std::vector<Particle> final;
-            for(const auto &part : event.Particles()) {
-                if(part.IsFinal()) final.push_back(part);
-            }
-            event.History().AddVertex(init_had.Position(), {init_had, init_lep}, {final},
-                                      EventHistory::StatusCode::primary); 
-        }
+    // TODO: Properly build history including the cascade
+    AddPrimaryVertex(event, init_had.Position(), had_id, lep_id);
 #endif
-        // TODO: Get remnant working
-        // Setup remnant in history
-        // auto recoilMom = init_nuc.Momentum();
-        // for(size_t i = 1; i < event.Leptons().size(); ++i) {
-        //     recoilMom -= event.Leptons()[i].Momentum();
-        // }
-        // for(size_t i = 1; i < event.Hadrons().size(); ++i) {
-        //     recoilMom -= event.Hadrons()[i].Momentum();
-        // }
-        // auto remnant = Particle(event.Remnant().PID(), recoilMom); 
-        // event.History().Primary()->AddOutgoing(remnant);
-
-        // Rotate cuts into plane of outgoing electron before writing
-        if (doRotate)
-            Rotate(event);
-        // Perform event-level final cuts before writing
-        bool outputCurrentEvent = true;
-        // if(doEventCuts){
-        //     spdlog::debug("Making event cuts");
-        //     outputCurrentEvent = MakeEventCuts(event);
-        // }
-
-        if(outputCurrentEvent) {
-            // Keep a running total of the number of surviving events
-            event.Finalize();
-
-            if(!unweighter->AcceptEvent(event)) {
-                // Update number of calls needed to ensure the number of generated events
-                // is the same as that requested by the user
-                integrator.Parameters().ncalls++;
-            }
-            writer -> Write(event);
-        }
-    } else {
-        unweighter->AddEvent(event);
-    }
+    // TODO: Get remnant working
+    // Setup remnant in history
+    // auto recoilMom = init_nuc.Momentum();
+    // for(size_t i = 1; i < event.Leptons().size(); ++i) {
+    //     recoilMom -= event.Leptons()[i].Momentum();
+    // }
+    // for(size_t i = 1; i < event.Hadrons().size(); ++i) {
+    //     recoilMom -= event.Hadrons()[i].Momentum();
+    // }
+    // auto remnant = Particle(event.Remnant().PID(), recoilMom); 
+    // event.History().Primary()->AddOutgoing(remnant);
+
+    // Rotate cuts into plane of outgoing electron before writing
+    if (doRotate)
+        Rotate(event);
+    // TODO: Perform event-level final cuts before writing
+    // if(doEventCuts){
+    //     spdlog::debug("Making event cuts");
+    //     outputCurrentEvent = MakeEventCuts(event);
+    // }
 
-#ifdef ENABLE_BSM
-    p_sherpa->Reset();
-#endif
+    event.Finalize();
+}
 
-    // Always return the weight when the event passes the initial hard cut.
-    // Even if events do not survive the final event-level cuts, Vegas should
-    // still interpret the integrand as nonzero in this region.
-    return event.Weight();
+void achilles::EventGen::WriteEvent(const Event &event) {
+    std::lock_guard<std::mutex> lock(*writer_mutex);
+    // Pass on the rejected events since the last write to normalize the cross section
+    if(m_ntrials > 0) {
+        writer -> AddTrials(m_ntrials);
+        m_ntrials = 0;
+    }
+    writer -> Write(event);
+}
+
+void achilles::EventGen::RejectEvent(const Event &event) {
+    spdlog::trace("Rejecting the event");
+    if(writeRejected) WriteEvent(event);
+    else m_ntrials++;
 }
 
 bool achilles::EventGen::MakeCuts(Event &event) {
-    return hard_cuts.EvaluateCuts(event.Particles());
+    return hard_cuts.EvaluateCuts(event.ParticlesView());
 }
 
 // TODO: Create Analysis level cuts
@@ -484,11 +1005,11 @@ bool achilles::EventGen::MakeEventCuts(Event &event) {
     return true;
 }*/
 
-void achilles::EventGen::Rotate(Event &event) {
+void achilles::EventGen::Rotate(Event &event) const {
     // Isolate the azimuthal angle of the outgoing electron
     double phi = 0.0;
-    for(const auto & particle : event.Particles()){
-        if(particle.ID() == PID::electron() && particle.IsFinal()){
+    for(const auto & particle : event.ParticlesView(PID::electron())){
+        if(particle.IsFinal()){
             phi = particle.Momentum().Phi();
         }
     }
@@ -1,96 +1,261 @@
 #include "Achilles/EventHistory.hh"
 
+#include <algorithm>
+#include <functional>
 #include <queue>
 
 using achilles::EventHistoryNode;
 using achilles::EventHistory;
 
-void EventHistory::AddVertex(ThreeVector position, const std::vector<Particle> &in,
-                             const std::vector<Particle> &out, StatusCode status) {
-    m_history.push_back(std::make_unique<EventHistoryNode>(cur_idx++, position, status));
-    for(const auto &part : in) {
-        m_history.back() -> AddIncoming(part);
+EventHistoryNode::EventHistoryNode(const EventHistoryNode &other)
+        : m_local{other.m_local}, m_table{other.OwnsParticles() ? &m_local : other.m_table},
+          m_ids_in{other.m_ids_in}, m_ids_out{other.m_ids_out}, m_idx{other.m_idx},
+          m_position{other.m_position}, m_status{other.m_status} {}
+
+EventHistoryNode& EventHistoryNode::operator=(const EventHistoryNode &other) {
+    if(this != &other) {
+        m_local = other.m_local;
+        m_table = other.OwnsParticles() ? &m_local : other.m_table;
+        m_ids_in = other.m_ids_in;
+        m_ids_out = other.m_ids_out;
+        m_idx = other.m_idx;
+        m_position = other.m_position;
+        m_status = other.m_status;
+    }
+    return *this;
+}
+
+EventHistory::EventHistory(const EventHistory &other) {
+    *this = other;
+}
+
+EventHistory::EventHistory(EventHistory &&other) noexcept {
+    *this = std::move(other);
+}
+
+EventHistory& EventHistory::operator=(const EventHistory &other) {
+    if(this != &other) {
+        // Copy into the existing vertices to keep their storage
+        Reset();
+        for(size_t i = 0; i < other.m_nnodes; ++i) {
+            const auto &node = other.m_nodes[i];
+            auto &copy = NewNode(node.m_position, node.m_status);
+            copy.m_ids_in = node.m_ids_in;
+            copy.m_ids_out = node.m_ids_out;
+        }
+        m_particles = other.m_particles;
+        m_node_in = other.m_node_in;
+        m_node_out = other.m_node_out;
+        m_lookup = other.m_lookup;
+        m_nlookup = other.m_nlookup;
+    }
+    return *this;
+}
+
+EventHistory& EventHistory::operator=(EventHistory &&other) noexcept {
+    if(this != &other) {
+        // Swap such that the moved from history keeps a pool to reuse
+        m_nodes.swap(other.m_nodes);
+        std::swap(m_nnodes, other.m_nnodes);
+        m_particles.swap(other.m_particles);
+        m_node_in.swap(other.m_node_in);
+        m_node_out.swap(other.m_node_out);
+        m_lookup.swap(other.m_lookup);
+        std::swap(m_nlookup, other.m_nlookup);
+        Rebind();
+        other.Rebind();
+        other.Reset();
     }
-    for(const auto &part : out) {
-        m_history.back() -> AddOutgoing(part);
+    return *this;
+}
+
+void EventHistory::Reset() {
+    m_nnodes = 0;
+    m_particles.clear();
+    m_node_in.clear();
+    m_node_out.clear();
+    std::fill(m_lookup.begin(), m_lookup.end(), 0);
+    m_nlookup = 0;
+}
+
+void EventHistory::Rebind() {
+    for(auto &node : m_nodes) node.m_table = &m_particles;
+}
+
+EventHistoryNode& EventHistory::NewNode(ThreeVector position, StatusCode status) {
+    if(m_nnodes < m_nodes.size())
+        m_nodes[m_nnodes].Reset(m_nnodes, position, status);
+    else
+        m_nodes.push_back(EventHistoryNode(&m_particles, m_nnodes, position, status));
+    return m_nodes[m_nnodes++];
+}
+
+void EventHistory::Link(EventHistoryNode &node, bool incoming, size_t id) {
+    (incoming ? node.m_ids_in : node.m_ids_out).push_back(id);
+    auto &first = incoming ? m_node_in[id] : m_node_out[id];
+    first = std::min(first, node.Index());
+}
+
+void EventHistory::Relink(EventHistoryNode &node, bool incoming, size_t slot, size_t id) {
+    auto &ids = incoming ? node.m_ids_in : node.m_ids_out;
+    auto &first = incoming ? m_node_in : m_node_out;
+    const size_t old = ids[slot];
+    ids[slot] = id;
+    first[id] = std::min(first[id], node.Index());
+    if(old == id || first[old] != node.Index()) return;
+
+    // Find the next vertex with the replaced particle, if any
+    first[old] = no_node;
+    for(size_t i = 0; i < m_nnodes; ++i) {
+        const auto &other = incoming ? m_nodes[i].m_ids_in : m_nodes[i].m_ids_out;
+        if(std::find(other.begin(), other.end(), old) != other.end()) {
+            first[old] = i;
+            break;
+        }
     }
 }
 
+void EventHistory::AddVertex(ThreeVector position, const std::vector<Particle> &in,
+                             const std::vector<Particle> &out, StatusCode status) {
+    auto &node = NewNode(position, status);
+    for(const auto &part : in) Link(node, true, ParticleID(part));
+    for(const auto &part : out) Link(node, false, ParticleID(part));
+}
+
+size_t EventHistory::AddParticle(const Particle &part) {
+    m_particles.push_back(part);
+    m_node_in.push_back(no_node);
+    m_node_out.push_back(no_node);
+    return m_particles.size() - 1;
+}
+
+void EventHistory::AddVertexByIds(ThreeVector position, const std::vector<size_t> &in,
+                                  const std::vector<size_t> &out, StatusCode status) {
+    auto &node = NewNode(position, status);
+    for(const auto &id : in) Link(node, true, id);
+    for(const auto &id : out) Link(node, false, id);
+}
+
 void EventHistory::AddParticleIn(size_t idx, const Particle &part) {
-    m_history[idx] -> AddIncoming(part);
+    Link(m_nodes[idx], true, ParticleID(part));
 }
 
 void EventHistory::AddParticleOut(size_t idx, const Particle &part) {
-    m_history[idx] -> AddOutgoing(part);
+    Link(m_nodes[idx], false, ParticleID(part));
 }
 
 void EventHistory::InsertShowerVert(ThreeVector position, const Particle &org, const Particle &in,
                                     const Particle &out_org, const std::vector<Particle> &other) {
     // Create shower node
-    m_history.push_back(std::make_unique<EventHistoryNode>(cur_idx++, position, StatusCode::shower));
-    m_history.back() -> AddIncoming(in);
-    m_history.back() -> AddOutgoing(out_org);
-    for(const auto &part : other)
-        m_history.back() -> AddOutgoing(part);
+    auto &shower = NewNode(position, StatusCode::shower);
+    Link(shower, true, ParticleID(in));
+    Link(shower, false, ParticleID(out_org));
+    for(const auto &part : other) Link(shower, false, ParticleID(part));
 
     // Insert in where original particle is located
     auto node_in = FindNodeIn(org);
     auto node_out = FindNodeOut(org);
-    auto it = std::find(node_in -> ParticlesIn().begin(), node_in -> ParticlesIn().end(), org);
-    *it = out_org;
-    it = std::find(node_out -> ParticlesOut().begin(), node_out -> ParticlesOut().end(), org);
-    *it = in;
+    auto particles_in = node_in -> ParticlesIn();
+    auto slot = std::distance(particles_in.begin(), std::find(particles_in.begin(), particles_in.end(), org));
+    Relink(*node_in, true, static_cast<size_t>(slot), ParticleID(out_org));
+    auto particles_out = node_out -> ParticlesOut();
+    slot = std::distance(particles_out.begin(), std::find(particles_out.begin(), particles_out.end(), org));
+    Relink(*node_out, false, static_cast<size_t>(slot), ParticleID(in));
+}
+
+bool EventHistory::ReplaceOutgoing(EventHistoryNode *node, const Particle &org, const Particle &part) {
+    auto particles = node -> ParticlesOut();
+    auto it = std::find_if(particles.begin(), particles.end(), compare_momentum(org));
+    if(it == particles.end()) return false;
+    const auto slot = static_cast<size_t>(std::distance(particles.begin(), it));
+    Relink(*node, false, slot, ParticleID(part));
+    return true;
+}
+
+size_t EventHistory::ParticleID(const Particle &part) {
+    // The vertices receive the particles by value, so the same particle is identified by its
+    // id, status, and momentum. Copies of a particle are identical, so they are looked up by
+    // their exact value
+    const size_t mask = m_lookup.size() - 1;
+    if(!m_lookup.empty()) {
+        for(size_t slot = HashParticle(part) & mask; m_lookup[slot] != 0; slot = (slot + 1) & mask) {
+            const auto &other = m_particles[m_lookup[slot] - 1];
+            if(other.ID() == part.ID() && other.Status() == part.Status()
+               && other.Momentum() == part.Momentum())
+                return m_lookup[slot] - 1;
+        }
+    }
+
+    const size_t id = AddParticle(part);
+    InsertLookup(id);
+    return id;
+}
+
+size_t EventHistory::HashParticle(const Particle &part) {
+    // Adding zero maps -0 to 0, which compare equal
+    size_t hash = std::hash<long>{}(static_cast<long>(part.ID()));
+    auto combine = [&hash](size_t value) {
+        hash ^= value + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+    };
+    combine(static_cast<size_t>(part.Status()));
+    for(size_t i = 0; i < 4; ++i) combine(std::hash<double>{}(part.Momentum()[i] + 0.0));
+    return hash;
+}
+
+void EventHistory::InsertLookup(size_t id) {
+    // Keep the table at most half full, rebuilding it from the linked particles when growing
+    if(2*(m_nlookup + 1) > m_lookup.size()) {
+        std::vector<size_t> ids;
+        for(const auto &entry : m_lookup)
+            if(entry != 0) ids.push_back(entry - 1);
+        m_lookup.assign(std::max<size_t>(16, 2*m_lookup.size()), 0);
+        m_nlookup = 0;
+        for(const auto &old : ids) InsertLookup(old);
+    }
+
+    const size_t mask = m_lookup.size() - 1;
+    size_t slot = HashParticle(m_particles[id]) & mask;
+    while(m_lookup[slot] != 0) slot = (slot + 1) & mask;
+    m_lookup[slot] = id + 1;
+    m_nlookup++;
 }
 
 std::vector<EventHistoryNode*> EventHistory::Children(size_t idx) const {
     std::vector<EventHistoryNode*> children;
-    for(const auto &part : m_history[idx] -> ParticlesOut()) {
-        auto node = FindNodeIn(part);
-        if(node) children.push_back(node);
+    for(const auto &id : m_nodes[idx].IdsOut()) {
+        if(m_node_in[id] != no_node) children.push_back(&m_nodes[m_node_in[id]]);
     }
     return children;
 }
 
 std::vector<EventHistoryNode*> EventHistory::Parents(size_t idx) const {
     std::vector<EventHistoryNode*> parents;
-    for(const auto &part : m_history[idx] -> ParticlesIn()) {
-        auto node = FindNodeOut(part);
-        if(node) parents.push_back(node);
+    for(const auto &id : m_nodes[idx].IdsIn()) {
+        if(m_node_out[id] != no_node) parents.push_back(&m_nodes[m_node_out[id]]);
     }
     return parents;
 }
 
 std::vector<EventHistoryNode*> EventHistory::Children(EventHistoryNode *node) const {
-    auto it = std::find_if(m_history.cbegin(), m_history.cend(), [&](const std::unique_ptr<EventHistoryNode> &p) {
-        return p.get() == node;
-    });
-    if(*it == nullptr) return {};
-    return Children((*it)->Index());
+    if(!node) return {};
+    return Children(node -> Index());
 }
 
 std::vector<EventHistoryNode*> EventHistory::Parents(EventHistoryNode *node) const {
-    auto it = std::find_if(m_history.cbegin(), m_history.cend(), [&](const std::unique_ptr<EventHistoryNode> &p) {
-        return p.get() == node;
-    });
-    if(it == m_history.end()) return {};
-    return Parents((*it)->Index());
+    if(!node) return {};
+    return Parents(node -> Index());
 }
 
 EventHistoryNode* EventHistory::Node(size_t idx) const {
-    for(const auto &node : m_history) {
-        if(node -> Index() == idx) {
-            return node.get();
-        }
-    }
-    return nullptr;
+    return idx < m_nnodes ? &m_nodes[idx] : nullptr;
 }
 
 EventHistoryNode* EventHistory::GetUniqueNode(StatusCode status) const {
     size_t n_nodes{};
     EventHistoryNode *result = nullptr;
-    for(const auto &node : m_history) {
-        if(node -> Status() == status) {
-            result = node.get();
+    for(size_t i = 0; i < m_nnodes; ++i) {
+        if(m_nodes[i].Status() == status) {
+            result = &m_nodes[i];
             n_nodes++;
         }
         if(n_nodes > 1) {
@@ -102,23 +267,21 @@ EventHistoryNode* EventHistory::GetUniqueNode(StatusCode status) const {
 }
 
 EventHistoryNode* EventHistory::FindNode(bool incoming, const Particle &part) const {
-    for(const auto &node : m_history) {
-        std::vector<Particle> particles;
-
-        if(incoming) {
-            if(node -> HasIncoming(part)) return node.get();
-        } else {
-            if(node -> HasOutgoing(part)) return node.get();
-        }
+    // Search the distinct particles, and return the first vertex with any of the matches
+    compare_momentum compare(part);
+    size_t first = no_node;
+    for(size_t id = 0; id < m_particles.size(); ++id) {
+        if(compare(m_particles[id]))
+            first = std::min(first, incoming ? m_node_in[id] : m_node_out[id]);
     }
-    return nullptr;
+    return first == no_node ? nullptr : &m_nodes[first];
 }
 
 void EventHistory::WalkHistory(achilles::HistoryVisitor &visitor) const {
     // Start at primary interaction
     auto *primary = Primary();
 
-    std::vector<size_t> visited;
+    std::vector<bool> visited(m_nnodes);
     size_t current = primary -> Index();
     std::queue<size_t> to_visit;
 
@@ -129,8 +292,7 @@ void EventHistory::WalkHistory(achilles::HistoryVisitor &visitor) const {
         to_visit.pop();
 
         // Ensure it hasn't been visited
-        if(std::find(visited.begin(), visited.end(), current) != visited.end())
-            continue;
+        if(visited[current]) continue;
 
         auto *node = Node(current);
         visitor.visit(node);
@@ -142,6 +304,6 @@ void EventHistory::WalkHistory(achilles::HistoryVisitor &visitor) const {
             to_visit.push(parent -> Index());
         }
 
-        visited.push_back(current);
+        visited[current] = true;
     }
 }
@@ -3,37 +3,198 @@
 #include "Achilles/Particle.hh"
 #include "Achilles/Version.hh"
 #include "fmt/format.h"
+#include "spdlog/spdlog.h"
 
-achilles::AchillesWriter::AchillesWriter(const std::string &filename, bool zip) : toFile{true}, zipped{zip} {
+#include <iterator>
+
+achilles::AchillesWriter::AchillesWriter(const std::string &filename, bool zip,
+                                         [[maybe_unused]] size_t threads)
+        : toFile{true}, zipped{zip} {
 #ifdef GZIP
     if(zipped) {
         std::string zipname = filename;
         if(filename.substr(filename.size() - 3) != ".gz")
             zipname += std::string(".gz");
-        m_out = new ogzstream(zipname.c_str());
+        if(threads > 0)
+            m_out = new BGZFStream(zipname, threads);
+        else
+            m_out = new ogzstream(zipname.c_str());
     } else
 #endif
         m_out = new std::ofstream(filename);
 }
 
+achilles::AchillesWriter::~AchillesWriter() {
+    if(!toFile) return;
+    try {
+        WriteBuffer();
+#ifdef GZIP
+        if(auto *bgzf = dynamic_cast<BGZFStream*>(m_out)) {
+            bgzf -> close();
+        } else if(zipped) {
+            dynamic_cast<ogzstream*>(m_out) -> close();
+        } else {
+            dynamic_cast<std::ofstream*>(m_out) -> close();
+        }
+#else
+        dynamic_cast<std::ofstream*>(m_out) -> close();
+#endif
+    } catch(const std::exception &error) {
+        spdlog::error("AchillesWriter: Failed to close the file: {}", error.what());
+    }
+    delete m_out;
+}
+
 void achilles::AchillesWriter::WriteHeader(const std::string &filename) {
-    *m_out << fmt::format("Achilles Version: {}\n", ACHILLES_VERSION);
-    *m_out << fmt::format("{0:-^40}\n\n", "");
+    auto out = std::back_inserter(m_buffer);
+    fmt::format_to(out, "Achilles Version: {}\n", ACHILLES_VERSION);
+    fmt::format_to(out, "{0:-^40}\n\n", "");
 
     std::ifstream input(filename);
     std::string line;
     while(std::getline(input, line)) {
-        *m_out << fmt::format("{}\n", line);
+        fmt::format_to(out, "{}\n", line);
     }
-    *m_out << fmt::format("{0:-^40}\n\n", "");
+    fmt::format_to(out, "{0:-^40}\n\n", "");
+    WriteBuffer();
 }
 
 void achilles::AchillesWriter::Write(const Event &event) {
-    *m_out << fmt::format("Event: {}\n", ++nEvents);
-    *m_out << fmt::format("  Particles:\n");
-    for(const auto &part : event.Particles()) {
-        *m_out << fmt::format("  - {}\n", part);
+    const double weight = event.Weight();
+    results += weight;
+    auto out = std::back_inserter(m_buffer);
+    fmt::format_to(out, "Event: {}\n", ++nEvents);
+    fmt::format_to(out, "  Particles:\n");
+    for(const auto &part : event.ParticlesView()) {
+        fmt::format_to(out, "  - {}\n", part);
     }
-    *m_out << fmt::format("  - {}\n", event.Remnant());
-    *m_out << fmt::format("  Weight: {}\n", event.Weight());
+    fmt::format_to(out, "  - {}\n", event.Remnant());
+    fmt::format_to(out, "  Weight: {}\n", weight);
+
+    // Pass whole events to the stream, and only full blocks when writing to a file
+    if(!toFile || m_buffer.size() >= buffer_size) WriteBuffer();
+}
+
+void achilles::AchillesWriter::AddTrials(size_t ntrials) {
+    results.AddZeros(ntrials);
+}
+
+void achilles::AchillesWriter::WriteFooter() {
+    auto out = std::back_inserter(m_buffer);
+    fmt::format_to(out, "{0:-^40}\n", "");
+    fmt::format_to(out, "Cross Section: {} +/- {} nb\n", results.Mean(), results.Error());
+    fmt::format_to(out, "Events: {}\n", results.FiniteCalls());
+    fmt::format_to(out, "Trials: {}\n", results.Calls());
+    WriteBuffer();
+}
+
+void achilles::AchillesWriter::WriteBuffer() {
+    if(m_buffer.size() == 0) return;
+    m_out -> write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    m_buffer.clear();
+}
+
+achilles::AsyncWriter::AsyncWriter(std::unique_ptr<EventWriter> writer, size_t capacity)
+    : m_writer{std::move(writer)}, m_queue{capacity}, m_events{capacity + 2} {
+    m_thread = std::thread([this]() { Drain(); });
+}
+
+achilles::AsyncWriter::~AsyncWriter() {
+    // Write the remaining events before the wrapped writer closes its file
+    m_queue.Close();
+    m_thread.join();
+    if(m_failed) spdlog::error("AsyncWriter: Events were lost due to an error while writing");
+}
+
+void achilles::AsyncWriter::WriteHeader(const std::string &filename) {
+    Item item;
+    item.type = Item::Type::Header;
+    item.header = filename;
+    Push(std::move(item));
+}
+
+void achilles::AsyncWriter::Write(const Event &event) {
+    Item item;
+    item.type = Item::Type::Event;
+    if(!m_events.TryPop(item.event)) item.event = std::make_unique<Event>();
+    item.event -> CopyFrom(event);
+    Push(std::move(item));
+}
+
+void achilles::AsyncWriter::AddTrials(size_t ntrials) {
+    if(ntrials == 0) return;
+    Item item;
+    item.type = Item::Type::Trials;
+    item.ntrials = ntrials;
+    Push(std::move(item));
+}
+
+void achilles::AsyncWriter::WriteFooter() {
+    Item item;
+    item.type = Item::Type::Footer;
+    Push(std::move(item));
+}
+
+void achilles::AsyncWriter::Flush() {
+    {
+        std::unique_lock<std::mutex> lock(m_flush_mutex);
+        m_flushing++;
+        const size_t target = m_pushed;
+        m_flushed.wait(lock, [&]() { return m_written >= target || m_failed; });
+        m_flushing--;
+    }
+    RethrowError();
+    m_writer -> Flush();
+}
+
+void achilles::AsyncWriter::Push(Item item) {
+    RethrowError();
+    m_pushed++;
+    if(!m_queue.Push(std::move(item))) RethrowError();
+}
+
+void achilles::AsyncWriter::Drain() {
+    Item item;
+    while(m_queue.Pop(item)) {
+        try {
+            switch(item.type) {
+                case Item::Type::Header:
+                    m_writer -> WriteHeader(item.header);
+                    break;
+                case Item::Type::Event:
+                    m_writer -> Write(*item.event);
+                    break;
+                case Item::Type::Trials:
+                    m_writer -> AddTrials(item.ntrials);
+                    break;
+                case Item::Type::Footer:
+                    m_writer -> WriteFooter();
+                    break;
+            }
+        } catch(...) {
+            // Stop accepting events, and report the error to the generating threads
+            m_error = std::current_exception();
+            m_failed = true;
+            m_queue.Close();
+            NotifyFlush();
+            return;
+        }
+        // Keep the event for a later copy, unless the pool is full
+        if(item.event && !m_events.TryPush(item.event)) item.event.reset();
+        m_written++;
+        NotifyFlush();
+    }
+}
+
+void achilles::AsyncWriter::NotifyFlush() {
+    // The counters are updated before checking for waiting threads, and the waiting threads
+    // register before checking the counters, so either side sees the other
+    if(m_flushing == 0) return;
+    std::lock_guard<std::mutex> lock(m_flush_mutex);
+    m_flushed.notify_all();
+}
+
+void achilles::AsyncWriter::RethrowError() {
+    // The error is set before the flag, and is not modified afterwards
+    if(m_failed) std::rethrow_exception(m_error);
 }
@@ -0,0 +1,128 @@
+#include "Achilles/HDF5Writer.hh"
+#include "Achilles/Event.hh"
+#include "Achilles/Particle.hh"
+#include "Achilles/Version.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "spdlog/spdlog.h"
+
+using achilles::HDF5Writer;
+
+template<typename T>
+HDF5Writer::Column<T>::Column(HighFive::File &file, const std::string &name, size_t chunk_size, bool zip)
+    : m_dataset{Create(file, name, chunk_size, zip)} {
+    m_buffer.reserve(chunk_size);
+}
+
+template<typename T>
+HighFive::DataSet HDF5Writer::Column<T>::Create(HighFive::File &file, const std::string &name,
+                                                size_t chunk_size, bool zip) {
+    HighFive::DataSpace space(std::vector<size_t>{0}, std::vector<size_t>{HighFive::DataSpace::UNLIMITED});
+    HighFive::DataSetCreateProps props;
+    props.add(HighFive::Chunking(std::vector<hsize_t>{chunk_size}));
+    if(zip) {
+        props.add(HighFive::Shuffle());
+        props.add(HighFive::Deflate(4));
+    }
+    return file.createDataSet<T>(name, space, props);
+}
+
+template<typename T>
+void HDF5Writer::Column<T>::Flush() {
+    if(m_buffer.empty()) return;
+    m_dataset.resize(std::vector<size_t>{m_size + m_buffer.size()});
+    m_dataset.select(std::vector<size_t>{m_size}, std::vector<size_t>{m_buffer.size()}).write(m_buffer);
+    m_size += m_buffer.size();
+    m_buffer.clear();
+}
+
+HDF5Writer::HDF5Writer(const std::string &filename, bool zip, size_t chunk_size)
+    : m_file{filename, HighFive::File::Overwrite}, m_chunk_size{std::max(chunk_size, size_t{1})},
+      m_weight{m_file, "events/weight", m_chunk_size, zip},
+      m_flux{m_file, "events/flux", m_chunk_size, zip},
+      m_remnant{m_file, "events/remnant", m_chunk_size, zip},
+      m_offset{m_file, "events/offset", m_chunk_size, zip},
+      m_pid{m_file, "particles/pid", m_chunk_size, zip},
+      m_status{m_file, "particles/status", m_chunk_size, zip},
+      m_E{m_file, "particles/E", m_chunk_size, zip},
+      m_px{m_file, "particles/px", m_chunk_size, zip},
+      m_py{m_file, "particles/py", m_chunk_size, zip},
+      m_pz{m_file, "particles/pz", m_chunk_size, zip},
+      m_x{m_file, "particles/x", m_chunk_size, zip},
+      m_y{m_file, "particles/y", m_chunk_size, zip},
+      m_z{m_file, "particles/z", m_chunk_size, zip} {}
+
+HDF5Writer::~HDF5Writer() {
+    try {
+        Flush();
+    } catch(const std::exception &error) {
+        spdlog::error("HDF5Writer: Failed to write the remaining events: {}", error.what());
+    }
+}
+
+void HDF5Writer::WriteHeader(const std::string &filename) {
+    std::ifstream input(filename);
+    std::stringstream card;
+    card << input.rdbuf();
+
+    const std::string version = ACHILLES_VERSION;
+    m_file.createAttribute<std::string>("version", HighFive::DataSpace::From(version)).write(version);
+    const std::string run_card = card.str();
+    m_file.createAttribute<std::string>("run_card", HighFive::DataSpace::From(run_card)).write(run_card);
+}
+
+void HDF5Writer::Write(const Event &event) {
+    const double weight = event.Weight();
+    results += weight;
+    m_weight.Append(weight);
+    m_flux.Append(event.Flux());
+    m_remnant.Append(event.Remnant().PID());
+    m_offset.Append(m_pid.Size());
+    for(const auto &part : event.ParticlesView()) {
+        m_pid.Append(static_cast<int>(part.ID()));
+        m_status.Append(static_cast<int>(part.Status()));
+        m_E.Append(part.Momentum().E());
+        m_px.Append(part.Momentum().Px());
+        m_py.Append(part.Momentum().Py());
+        m_pz.Append(part.Momentum().Pz());
+        m_x.Append(part.Position().X());
+        m_y.Append(part.Position().Y());
+        m_z.Append(part.Position().Z());
+    }
+
+    // Write full chunks of the event columns, which also bounds the particle buffers
+    if(m_weight.Size() % m_chunk_size == 0) Flush();
+}
+
+void HDF5Writer::AddTrials(size_t ntrials) {
+    results.AddZeros(ntrials);
+}
+
+void HDF5Writer::WriteFooter() {
+    const double xsec = results.Mean(), error = results.Error();
+    const size_t nevents = results.FiniteCalls(), ntrials = results.Calls();
+    m_file.createAttribute<double>("cross_section", HighFive::DataSpace::From(xsec)).write(xsec);
+    m_file.createAttribute<double>("cross_section_error", HighFive::DataSpace::From(error)).write(error);
+    m_file.createAttribute<size_t>("events", HighFive::DataSpace::From(nevents)).write(nevents);
+    m_file.createAttribute<size_t>("trials", HighFive::DataSpace::From(ntrials)).write(ntrials);
+}
+
+void HDF5Writer::Flush() {
+    m_weight.Flush();
+    m_flux.Flush();
+    m_remnant.Flush();
+    m_offset.Flush();
+    m_pid.Flush();
+    m_status.Flush();
+    m_E.Flush();
+    m_px.Flush();
+    m_py.Flush();
+    m_pz.Flush();
+    m_x.Flush();
+    m_y.Flush();
+    m_z.Flush();
+    m_file.flush();
+}
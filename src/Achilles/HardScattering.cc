@@ -216,7 +216,8 @@ std::vector<double> HardScattering::CrossSection(Event &event) const {
     // Calculate the hadronic currents
     // TODO: Clean this up and make generic for the nuclear model
     // TODO: Move this to initialization to remove check each time
-    static std::vector<NuclearModel::FFInfoMap> ffInfo;
+    // The form factor info is cached per instance, so that each thread owns its copy
+    auto &ffInfo = m_ffInfo;
     if(ffInfo.empty()) {
         ffInfo.resize(3);
         for(const auto &current : leptonCurrent) {
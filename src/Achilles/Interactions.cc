@@ -1,6 +1,7 @@
 #include <iostream>
 #include <fstream>
 #include <map>
+#include <stdexcept>
 
 #include "Achilles/Potential.hh"
 #include "spdlog/spdlog.h"
@@ -221,20 +222,19 @@ double GeantInteractions::CrossSection(const Particle& particle1,
     // Generate outgoing momentum
     const double pcm = p1CM.Vec3().Magnitude();
 
-    try {
-        if(samePID) {
-            return m_crossSectionPP(pcm/1_GeV);
-        } else {
-            return m_crossSectionNP(pcm/1_GeV);
-        }
-    } catch (std::domain_error &e) {
-        spdlog::trace("Using Nasa Interaction");
-        // double s = (p1Lab+p2Lab).M2();
-        double s = (particle1.Momentum()+particle2.Momentum()).M2();
-        double smin = pow(particle1.Mass(), 2) + pow(particle2.Mass(), 2);
-        double plab = sqrt(pow(s, 2)/smin - s);
-        return Interactions::CrossSectionLab(samePID, plab);
-    }
+    double xsec{};
+    const auto &interp = samePID ? m_crossSectionPP : m_crossSectionNP;
+    const auto status = interp.TryEvaluate(pcm/1_GeV, xsec);
+    if(status == InterpStatus::Success) return xsec;
+    if(status == InterpStatus::NotInitialized)
+        throw std::runtime_error("GeantInteractions: Cross section interpolation is not initialized!");
+
+    spdlog::trace("Using Nasa Interaction");
+    // double s = (p1Lab+p2Lab).M2();
+    double s = (particle1.Momentum()+particle2.Momentum()).M2();
+    double smin = pow(particle1.Mass(), 2) + pow(particle2.Mass(), 2);
+    double plab = sqrt(pow(s, 2)/smin - s);
+    return Interactions::CrossSectionLab(samePID, plab);
 }
 
 ThreeVector GeantInteractions::MakeMomentum(bool samePID,
@@ -249,13 +249,15 @@ ThreeVector GeantInteractions::MakeMomentum(bool samePID,
 
 double GeantInteractions::CrossSectionAngle(bool samePID, const double& energy,
                                             const double& ran) const {
-    try{
-        if(samePID) return m_thetaDistPP(energy, ran);
-        else return m_thetaDistNP(energy, ran);
-    } catch(std::domain_error &e) {
-        spdlog::trace("Using flat angular distribution");
-        return acos(2*ran-1);
-    }
+    double theta{};
+    const auto &interp = samePID ? m_thetaDistPP : m_thetaDistNP;
+    const auto status = interp.TryEvaluate(energy, ran, theta);
+    if(status == InterpStatus::Success) return theta;
+    if(status == InterpStatus::NotInitialized)
+        throw std::runtime_error("GeantInteractions: Angular interpolation is not initialized!");
+
+    spdlog::trace("Using flat angular distribution");
+    return acos(2*ran-1);
 }
 
 /*
@@ -116,8 +116,24 @@ double Interp1D::operator()(const double& x) const {
     if(x < knotX.front()) 
         throw std::domain_error(fmt::format("Input ({}) less than minimum value ({})", x, knotX.front()));
 
+    return Evaluate(x);
+}
+
+InterpStatus Interp1D::TryEvaluate(const double &x, double &result) const {
+    if(!kSplineInit && kMode == InterpolationType::CubicSpline)
+        return InterpStatus::NotInitialized;
+    if(!(x <= knotX.back())) return InterpStatus::AboveRange;
+    if(x < knotX.front()) return InterpStatus::BelowRange;
+
+    result = Evaluate(x);
+    return InterpStatus::Success;
+}
+
+double Interp1D::Evaluate(double x) const {
     // Find range by binary_search
     auto idxHigh = static_cast<size_t>(std::distance(knotX.begin(), std::upper_bound(knotX.begin(), knotX.end(), x)));
+    // The upper edge belongs to the last interval
+    idxHigh = std::min(idxHigh, knotX.size() - 1);
     auto idxLow = idxHigh-1;
 
     double result = 0;
@@ -171,12 +187,48 @@ Interp2D::Interp2D(const std::vector<double>& x, const std::vector<double>& y,
     knotZ = z;
 }
 
+namespace {
+
+// Returns the inverse of the spacing if the knots are equally spaced, and zero otherwise
+double UniformStep(const std::vector<double> &knots) {
+    constexpr double tolerance = 1e-12;
+    const double step = (knots.back() - knots.front())/static_cast<double>(knots.size() - 1);
+    for(size_t i = 1; i < knots.size(); ++i) {
+        if(std::abs(knots[i] - knots[i-1] - step) > tolerance*step) return 0;
+    }
+    return 1.0/step;
+}
+
+}
+
 void Interp2D::BicubicSpline() {
-    for(std::size_t i = 0; i < knotX.size(); ++i) {
-        derivs2.emplace_back(knotY, std::vector<double>(knotZ.begin()+static_cast<int>(i*knotY.size()), knotZ.begin()+static_cast<int>((i+1)*knotY.size())));
-        derivs2.back().CubicSpline();
+    const size_t nx = knotX.size();
+    const size_t ny = knotY.size();
+    coeffs.resize(nx*ny);
+    for(size_t i = 0; i < nx*ny; ++i) coeffs[i][0] = knotZ[i];
+
+    // Second derivatives in y along each row of fixed x
+    std::vector<double> row(ny);
+    for(size_t i = 0; i < nx; ++i) {
+        for(size_t j = 0; j < ny; ++j) row[j] = coeffs[i*ny+j][0];
+        Interp1D spline(knotY, row);
+        spline.CubicSpline();
+        for(size_t j = 0; j < ny; ++j) coeffs[i*ny+j][2] = spline.SecondDerivatives()[j];
     }
 
+    // Second derivatives in x of the values and of the y derivatives along each column
+    std::vector<double> column(nx);
+    for(size_t j = 0; j < ny; ++j) {
+        for(size_t k = 0; k < 2; ++k) {
+            for(size_t i = 0; i < nx; ++i) column[i] = coeffs[i*ny+j][2*k];
+            Interp1D spline(knotX, column);
+            spline.CubicSpline();
+            for(size_t i = 0; i < nx; ++i) coeffs[i*ny+j][2*k+1] = spline.SecondDerivatives()[i];
+        }
+    }
+
+    invStepX = UniformStep(knotX);
+    invStepY = UniformStep(knotY);
     kSplineInit = true;
 }
 
@@ -195,7 +247,20 @@ double Interp2D::operator()(const double& x, const double& y) const {
     if(y < knotY.front()) 
         throw std::domain_error(fmt::format("Input ({}) less than minimum y value ({})", y, knotY.front()));
 
+    return Evaluate(x, y);
+}
+
+InterpStatus Interp2D::TryEvaluate(const double &x, const double &y, double &result) const {
+    if(!kSplineInit && kMode == InterpolationType::CubicSpline)
+        return InterpStatus::NotInitialized;
+    if(!(x <= knotX.back()) || !(y <= knotY.back())) return InterpStatus::AboveRange;
+    if(x < knotX.front() || y < knotY.front()) return InterpStatus::BelowRange;
+
+    result = Evaluate(x, y);
+    return InterpStatus::Success;
+}
 
+double Interp2D::Evaluate(double x, double y) const {
     double result = 0;
     switch(kMode) {
         case InterpolationType::NearestNeighbor:
@@ -205,20 +270,56 @@ double Interp2D::operator()(const double& x, const double& y) const {
             result = PolynomialInterp(x, y);
             break;
         case InterpolationType::CubicSpline:
-            std::vector<double> zTmp(knotX.size()); 
-            for(std::size_t i = 0; i < knotX.size(); ++i)
-                zTmp[i] = derivs2[i](y);
-
-            Interp1D interp(knotX, zTmp);
-            interp.SetType(InterpolationType::CubicSpline);
-            interp.CubicSpline();
-            result = interp(x);
+            result = BicubicInterp(x, y);
             break;
     }
 
     return result;
 }
 
+size_t Interp2D::FindCell(const std::vector<double> &knots, double invStep, double x) {
+    size_t idx{};
+    if(invStep > 0) {
+        idx = static_cast<size_t>((x - knots.front())*invStep);
+    } else {
+        idx = static_cast<size_t>(std::distance(knots.begin(),
+                                                std::upper_bound(knots.begin(), knots.end(), x)));
+        idx = idx > 0 ? idx - 1 : 0;
+    }
+    return std::min(idx, knots.size() - 2);
+}
+
+double Interp2D::BicubicInterp(double x, double y) const {
+    const size_t ny = knotY.size();
+    const size_t idxX = FindCell(knotX, invStepX, x);
+    const size_t idxY = FindCell(knotY, invStepY, y);
+
+    // Cubic spline weights of the low and high knots for the values and second derivatives
+    const double heightX = knotX[idxX+1] - knotX[idxX];
+    const double ax = (knotX[idxX+1] - x)/heightX;
+    const double bx = 1 - ax;
+    const std::array<double, 2> wx{ax, bx};
+    const std::array<double, 2> wx2{(ipow(ax, 3) - ax)*heightX*heightX/6.0,
+                                    (ipow(bx, 3) - bx)*heightX*heightX/6.0};
+
+    const double heightY = knotY[idxY+1] - knotY[idxY];
+    const double ay = (knotY[idxY+1] - y)/heightY;
+    const double by = 1 - ay;
+    const std::array<double, 2> wy{ay, by};
+    const std::array<double, 2> wy2{(ipow(ay, 3) - ay)*heightY*heightY/6.0,
+                                    (ipow(by, 3) - by)*heightY*heightY/6.0};
+
+    double result = 0;
+    for(size_t i = 0; i < 2; ++i) {
+        for(size_t j = 0; j < 2; ++j) {
+            const auto &c = coeffs[(idxX+i)*ny + idxY+j];
+            result += wx[i]*(wy[j]*c[0] + wy2[j]*c[2]) + wx2[i]*(wy[j]*c[1] + wy2[j]*c[3]);
+        }
+    }
+
+    return result;
+}
+
 double Interp2D::NearestNeighbor(double x, double y) const {
     // Find range by binary_search
     auto idxHighX = static_cast<size_t>(std::distance(knotX.begin(), std::upper_bound(knotX.begin(), knotX.end(), x)));
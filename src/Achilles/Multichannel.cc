@@ -5,6 +5,7 @@ achilles::MultiChannel::MultiChannel(size_t dims, size_t nchannels, MultiChannel
     for(size_t i = 0; i < nchannels; ++i) {
         channel_weights.push_back(1.0/static_cast<double>(nchannels));
     }
+    if(nchannels > 0) channel_sampler.Build(channel_weights);
 }
 
 void achilles::MultiChannel::Adapt(const std::vector<double> &train) {
@@ -32,6 +33,7 @@ void achilles::MultiChannel::Adapt(const std::vector<double> &train) {
     }
 
     channel_weights = new_weights;
+    channel_sampler.Build(channel_weights);
 }
 
 void achilles::MultiChannel::MaxDifference(const std::vector<double> &train) {
@@ -52,6 +54,18 @@ void achilles::MultiChannel::MaxDifference(const std::vector<double> &train) {
     }
 }
 
+void achilles::MultiChannel::MergeIterations(const std::vector<MultiChannel> &workers) {
+    // Merge in a fixed order to keep the result reproducible
+    StatsData results;
+    for(const auto &worker : workers) {
+        next_event = std::max(next_event, worker.next_event);
+        if(worker.summary.results.empty()) continue;
+        results += worker.summary.results.back();
+    }
+    summary.results.push_back(results);
+    summary.sum_results += results;
+}
+
 achilles::MultiChannelSummary achilles::MultiChannel::Summary() {
     summary.best_weights = best_weights;
     std::cout << "Final integral = "
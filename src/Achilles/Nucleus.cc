@@ -31,7 +31,7 @@ const std::map<std::size_t, std::string> Nucleus::ZToName = {
 
 Nucleus::Nucleus(const std::size_t& Z, const std::size_t& A, const double& bEnergy,
                  const double& kf, const std::string& densityFilename, const FermiGasType& fgType,
-                 std::unique_ptr<Density> _density) 
+                 std::shared_ptr<Density> _density) 
                         : binding(bEnergy), fermiMomentum(kf), fermiGas(fgType),
                           density(std::move(_density)) {
     
@@ -115,10 +115,14 @@ Nucleus::Nucleus(const std::size_t& Z, const std::size_t& A, const double& bEner
 
 void Nucleus::SetNucleons(Particles& _nucleons) noexcept {
     std::swap(nucleons, _nucleons);
+    SortNucleons();
+}
+
+void Nucleus::SortNucleons() noexcept {
     std::size_t idx = 0;
     std::size_t proton_idx = 0;
     std::size_t neutron_idx = 0;
-    for(auto particle : nucleons) {
+    for(const auto &particle : nucleons) {
         if(particle.ID() == PID::proton()) {
             protons[proton_idx] = particle;
             protonLoc[proton_idx++] = idx++;
@@ -131,10 +135,11 @@ void Nucleus::SetNucleons(Particles& _nucleons) noexcept {
 }
 
 void Nucleus::GenerateConfig() {
-    // Get a configuration from the density function
-    Particles particles = density -> GetConfiguration();
+    // Overwrite the nucleons with a configuration from the density function, which reuses
+    // the storage of the previous configuration
+    density -> FillConfiguration(nucleons);
 
-    for(Particle& particle : particles) {
+    for(Particle& particle : nucleons) {
         // Set momentum for each nucleon
         auto mom3 = GenerateMomentum(particle.Position().Magnitude());
         double energy2 = pow(particle.Info().Mass(), 2); // Constant::mN*Constant::mN;
@@ -145,8 +150,8 @@ void Nucleus::GenerateConfig() {
         particle.Status() = ParticleStatus::background;
     }
 
-    // Update the nucleons in the nucleus
-    SetNucleons(particles);
+    // Update the protons and neutrons in the nucleus
+    SortNucleons();
 }
 
 const std::array<double, 3> Nucleus::GenerateMomentum(const double &position) noexcept {
@@ -161,7 +166,7 @@ const std::array<double, 3> Nucleus::GenerateMomentum(const double &position) no
 Nucleus Nucleus::MakeNucleus(const std::string& name, const double& bEnergy,
                              const double& fermiMomentum,
                              const std::string& densityFilename, const FermiGasType& fg_type,
-                             std::unique_ptr<Density> density) {
+                             std::shared_ptr<Density> density) {
     const std::regex regex("([0-9]+)([a-zA-Z]+)");
     std::smatch match;
 
@@ -193,6 +198,24 @@ const std::string Nucleus::ToString() const noexcept {
     return std::to_string(NNucleons()) + ZToName.at(NProtons());
 }
 
+std::shared_ptr<Nucleus> Nucleus::Clone() const {
+    auto result = std::make_shared<Nucleus>();
+    result -> nucleons = nucleons;
+    result -> protons = protons;
+    result -> neutrons = neutrons;
+    result -> protonLoc = protonLoc;
+    result -> neutronLoc = neutronLoc;
+    result -> binding = binding;
+    result -> fermiMomentum = fermiMomentum;
+    result -> radius = radius;
+    result -> fermiGas = fermiGas;
+    result -> density = density;
+    result -> rhoInterp = rhoInterp;
+    result -> m_recoil = m_recoil;
+    result -> m_pid = m_pid;
+    return result;
+}
+
 double Nucleus::FermiMomentum(const double &position) const noexcept { 
     double rho = Rho(position);
     double result{};
@@ -1,9 +1,13 @@
 #include "Achilles/Settings.hh"
 #include "Achilles/System.hh"
 #include "Achilles/Utilities.hh"
+#include "Achilles/Version.hh"
 #include "spdlog/spdlog.h"
+#include <array>
+#include <fstream>
 #include <functional>
 #include <iostream>
+#include <optional>
 
 // Demangling taken from: https://stackoverflow.com/a/34916852
 #ifdef __GNUG__
@@ -22,6 +26,21 @@ std::string achilles::demangle(const char *name) {
 
 using achilles::Settings;
 
+namespace {
+
+// Find a file named by an option in the search path. Most options do not name a file, so
+// unlike FindFile this does not fail or warn if it is not found
+std::optional<fs::path> FindOptionFile(const std::string &name) {
+    if(name.empty()) return std::nullopt;
+    for(const auto &dir : achilles::Filesystem::AchillesPath()) {
+        std::error_code error;
+        if(fs::is_regular_file(dir / name, error)) return dir / name;
+    }
+    return std::nullopt;
+}
+
+}
+
 Settings::Settings(const std::string &filename) {
     m_settings = IncludeFile(filename);
     CheckRequired();
@@ -77,6 +96,40 @@ YAML::Node Settings::IncludeFile(const std::string &filename) {
     return node;
 }
 
+uint64_t Settings::Hash(const std::vector<std::string_view> &keys) const {
+    // 64-bit FNV-1a, since std::hash is not guaranteed to be stable between runs
+    uint64_t hash = 0xcbf29ce484222325;
+    auto add = [&hash](std::string_view str) {
+        for(const auto &c : str) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 0x100000001b3;
+        }
+    };
+
+    // Options naming a file also add its content, such that e.g. editing a parameter card
+    // changes the hash
+    auto add_file = [&add](const YAML::Node &scalar) {
+        const auto path = FindOptionFile(scalar.Scalar());
+        if(!path) return;
+        std::ifstream file(*path, std::ios::binary);
+        std::array<char, 4096> buffer{};
+        while(file.read(buffer.data(), buffer.size()) || file.gcount() > 0)
+            add(std::string_view(buffer.data(), static_cast<size_t>(file.gcount())));
+    };
+
+    // The meaning of the options may change between versions
+    add(ACHILLES_VERSION);
+    add("\n");
+    for(const auto &key : keys) {
+        add(key);
+        add(": ");
+        add(Exists(key) ? YAML::Dump((*this)[key]) : "~");
+        add("\n");
+        if(Exists(key)) ConstYAMLVisitor{add_file}((*this)[key]);
+    }
+    return hash;
+}
+
 void Settings::CheckRequired() const {
     for(const auto &option : m_required_options) {
         spdlog::trace("Looking for option {}", option);
@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "Achilles/SpatialGrid.hh"
+#include "Achilles/Particle.hh"
+
+using achilles::SpatialGrid;
+
+void SpatialGrid::Build(const Particles &particles) {
+    // Determine the bounding box of the background particles
+    constexpr double big = std::numeric_limits<double>::max();
+    std::array<double, 3> lower{big, big, big}, upper{-big, -big, -big};
+    for(const auto &particle : particles) {
+        if(particle.Status() != ParticleStatus::background) continue;
+        for(std::size_t i = 0; i < 3; ++i) {
+            lower[i] = std::min(lower[i], particle.Position()[i]);
+            upper[i] = std::max(upper[i], particle.Position()[i]);
+        }
+    }
+
+    // Setup the cells, using a single cell if no background particles exist
+    for(std::size_t i = 0; i < 3; ++i) {
+        if(lower[i] > upper[i]) lower[i] = upper[i] = 0;
+        m_min[i] = lower[i];
+        m_ncells[i] = static_cast<std::size_t>((upper[i] - lower[i])/m_cellSize) + 1;
+    }
+    m_cells.assign(m_ncells[0]*m_ncells[1]*m_ncells[2], {});
+    m_cellOf.assign(particles.size(), npos);
+    m_size = 0;
+
+    for(std::size_t idx = 0; idx < particles.size(); ++idx) {
+        if(particles[idx].Status() != ParticleStatus::background) continue;
+        Insert(idx, particles[idx].Position());
+    }
+}
+
+void SpatialGrid::Insert(std::size_t idx, const ThreeVector &position) {
+    if(m_cells.empty()) {
+        m_ncells = {1, 1, 1};
+        m_cells.resize(1);
+    }
+    if(idx >= m_cellOf.size()) m_cellOf.resize(idx + 1, npos);
+    if(m_cellOf[idx] != npos) Remove(idx);
+
+    const auto cell = CellIndex(position);
+    m_cells[cell].push_back(idx);
+    m_cellOf[idx] = cell;
+    m_size++;
+}
+
+void SpatialGrid::Remove(std::size_t idx) {
+    if(!Contains(idx)) return;
+
+    auto &cell = m_cells[m_cellOf[idx]];
+    auto it = std::find(cell.begin(), cell.end(), idx);
+    *it = cell.back();
+    cell.pop_back();
+    m_cellOf[idx] = npos;
+    m_size--;
+}
+
+void SpatialGrid::Query(const ThreeVector &start, const ThreeVector &end, double radius,
+                        std::vector<std::size_t> &result) const {
+    result.clear();
+    if(m_size == 0) return;
+
+    // Find the range of cells overlapping the bounding box of the cylinder.
+    // The end caps of the cylinder extend by radius*sqrt(1-n_i^2) in each direction,
+    // where n is the unit vector along the axis
+    const auto axis = end - start;
+    const double length = axis.Magnitude();
+    std::array<std::size_t, 3> lower{}, upper{};
+    for(std::size_t i = 0; i < 3; ++i) {
+        double extent = radius;
+        if(length > 0) extent *= std::sqrt(std::max(0.0, 1 - pow(axis[i]/length, 2)));
+        lower[i] = CellCoord(std::min(start[i], end[i]) - extent, i);
+        upper[i] = CellCoord(std::max(start[i], end[i]) + extent, i);
+    }
+
+    for(std::size_t ix = lower[0]; ix <= upper[0]; ++ix) {
+        for(std::size_t iy = lower[1]; iy <= upper[1]; ++iy) {
+            for(std::size_t iz = lower[2]; iz <= upper[2]; ++iz) {
+                const auto &cell = m_cells[(ix*m_ncells[1] + iy)*m_ncells[2] + iz];
+                result.insert(result.end(), cell.begin(), cell.end());
+            }
+        }
+    }
+}
+
+void SpatialGrid::Clear() {
+    for(auto &cell : m_cells) cell.clear();
+    std::fill(m_cellOf.begin(), m_cellOf.end(), npos);
+    m_size = 0;
+}
+
+std::size_t SpatialGrid::CellCoord(double x, std::size_t dim) const noexcept {
+    const double coord = std::floor((x - m_min[dim])/m_cellSize);
+    if(coord <= 0) return 0;
+    return std::min(static_cast<std::size_t>(coord), m_ncells[dim] - 1);
+}
+
+std::size_t SpatialGrid::CellIndex(const ThreeVector &position) const noexcept {
+    return (CellCoord(position[0], 0)*m_ncells[1] + CellCoord(position[1], 1))*m_ncells[2]
+        + CellCoord(position[2], 2);
+}
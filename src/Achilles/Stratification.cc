@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "Achilles/Stratification.hh"
+#include "spdlog/spdlog.h"
+
+using achilles::Stratification;
+
+Stratification::Stratification(size_t dims, size_t nstrat) : m_dims{dims}, m_nstrat{nstrat} {
+    if(m_dims == 0 || m_nstrat == 0) {
+        m_nstrat = 0;
+        return;
+    }
+
+    // Reduce the number of strata until the hypercubes fit into the limit
+    const auto limit = static_cast<size_t>(std::pow(static_cast<double>(max_cubes),
+                                                    1.0/static_cast<double>(m_dims)) + 1e-6);
+    m_nstrat = std::min(m_nstrat, limit);
+    size_t ncubes = 1;
+    for(size_t i = 0; i < m_dims; ++i) ncubes *= m_nstrat;
+    if(m_nstrat != nstrat)
+        spdlog::warn("Stratification: Reduced strata per dimension from {} to {}", nstrat, m_nstrat);
+    if(m_nstrat < 2) {
+        m_nstrat = 0;
+        return;
+    }
+
+    m_prob.assign(ncubes, 1.0/static_cast<double>(ncubes));
+    m_sampler.Build(m_prob);
+}
+
+double Stratification::operator()(std::vector<double> &rans) const {
+    size_t cube = Random::Instance().SelectIndex(m_sampler);
+    const double weight = 1.0/(static_cast<double>(NCubes())*m_prob[cube]);
+
+    // The last dimension varies fastest with the index of the hypercube
+    const auto nstrat = static_cast<double>(m_nstrat);
+    for(size_t i = m_dims; i-- > 0;) {
+        rans[i] = (static_cast<double>(cube % m_nstrat) + rans[i])/nstrat;
+        cube /= m_nstrat;
+    }
+
+    return weight;
+}
+
+double Stratification::GenerateWeight(const AdaptiveMap &grid, const std::vector<double> &x) const {
+    return 1.0/(static_cast<double>(NCubes())*m_prob[FindCube(grid, x)]);
+}
+
+size_t Stratification::FindCube(const AdaptiveMap &grid, const std::vector<double> &x) const {
+    size_t cube = 0;
+    const auto nstrat = static_cast<double>(m_nstrat);
+    for(size_t i = 0; i < m_dims; ++i) {
+        const double position = grid.Inverse(i, x[i])*nstrat;
+        const size_t coord = position <= 0 ? 0 : std::min(static_cast<size_t>(position), m_nstrat - 1);
+        cube = cube*m_nstrat + coord;
+    }
+    return cube;
+}
+
+void Stratification::AddTrainData(const AdaptiveMap &grid, const std::vector<double> &x, double val) {
+    if(m_sum.empty()) {
+        m_sum.resize(NCubes());
+        m_sum2.resize(NCubes());
+        m_count.resize(NCubes());
+    }
+
+    // Remove the weight of the stratification to estimate the variance within the hypercube
+    const size_t cube = FindCube(grid, x);
+    const double value = val*static_cast<double>(NCubes())*m_prob[cube];
+    m_sum[cube] += value;
+    m_sum2[cube] += value*value;
+    m_count[cube]++;
+}
+
+void Stratification::MergeTrainData(Stratification &other) {
+    if(other.m_sum.empty()) return;
+    if(m_sum.empty()) {
+        m_sum.resize(NCubes());
+        m_sum2.resize(NCubes());
+        m_count.resize(NCubes());
+    }
+
+    for(size_t i = 0; i < m_sum.size(); ++i) {
+        m_sum[i] += other.m_sum[i];
+        m_sum2[i] += other.m_sum2[i];
+        m_count[i] += other.m_count[i];
+    }
+    std::fill(other.m_sum.begin(), other.m_sum.end(), 0);
+    std::fill(other.m_sum2.begin(), other.m_sum2.end(), 0);
+    std::fill(other.m_count.begin(), other.m_count.end(), 0);
+}
+
+void Stratification::ResetTrainData() {
+    std::fill(m_sum.begin(), m_sum.end(), 0);
+    std::fill(m_sum2.begin(), m_sum2.end(), 0);
+    std::fill(m_count.begin(), m_count.end(), 0);
+}
+
+void Stratification::Adapt(double beta) {
+    if(m_sum.empty()) return;
+
+    // Estimate the root mean square of the integrand in each sampled hypercube. Since the
+    // hypercubes are selected at random instead of being filled with a fixed number of points,
+    // this gives the optimal probabilities rather than the standard deviation
+    std::vector<double> sigma(NCubes(), -1);
+    double sum_sigma = 0;
+    size_t nsampled = 0;
+    for(size_t i = 0; i < NCubes(); ++i) {
+        if(m_count[i] == 0) continue;
+        sigma[i] = std::sqrt(m_sum2[i]/static_cast<double>(m_count[i]));
+        sum_sigma += sigma[i];
+        nsampled++;
+    }
+    ResetTrainData();
+    if(nsampled == 0 || sum_sigma == 0) return;
+
+    // Hypercubes without an estimate use the average. The new probabilities
+    // are mixed with the uniform distribution to keep sampling every hypercube
+    const double average = sum_sigma/static_cast<double>(nsampled);
+    std::vector<double> prob(NCubes());
+    double norm = 0;
+    for(size_t i = 0; i < NCubes(); ++i) {
+        prob[i] = pow(sigma[i] < 0 ? average : sigma[i], beta);
+        norm += prob[i];
+    }
+    const double uniform = 1.0/static_cast<double>(NCubes());
+    for(auto &p : prob) p = (1 - cMix)*p/norm + cMix*uniform;
+
+    SetProbabilities(std::move(prob));
+}
+
+void Stratification::SetProbabilities(std::vector<double> prob) {
+    if(prob.size() != NCubes())
+        throw std::runtime_error("Stratification: Number of probabilities does not match hypercubes");
+    m_sampler.Build(prob);
+    m_prob = std::move(prob);
+}
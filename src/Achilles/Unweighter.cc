@@ -4,16 +4,9 @@
 #include "Achilles/Random.hh"
 
 using achilles::PercentileUnweighter;
+using achilles::QuantileUnweighter;
 
-PercentileUnweighter::PercentileUnweighter(const YAML::Node &node)
-    : m_percentile{node["percentile"].as<double>()/100} {}
-
-void PercentileUnweighter::AddEvent(const achilles::Event &event) {
-    m_percentile.Add(event.Weight());
-}
-
-bool PercentileUnweighter::AcceptEvent(achilles::Event &event) {
-    double max_wgt = m_percentile.Get(); 
+bool achilles::Unweighter::AcceptWeight(Event &event, double max_wgt) {
     double prob = event.Weight() / max_wgt;
     m_total++;
 
@@ -27,6 +20,101 @@ bool PercentileUnweighter::AcceptEvent(achilles::Event &event) {
     return true;
 }
 
+PercentileUnweighter::PercentileUnweighter(const YAML::Node &node)
+    : m_percentile{node["percentile"].as<double>()/100} {}
+
+void PercentileUnweighter::AddEvent(const achilles::Event &event) {
+    m_percentile.Add(event.Weight());
+}
+
+void PercentileUnweighter::AddEvents(const achilles::Unweighter &other) {
+    m_percentile.Merge(dynamic_cast<const PercentileUnweighter&>(other).m_percentile);
+}
+
+YAML::Node PercentileUnweighter::ToYAML() const {
+    YAML::Node node;
+    node["Name"] = Name();
+    if(m_percentile.Size() > 0) node["MaxWeight"] = m_percentile.Get();
+    return node;
+}
+
+bool PercentileUnweighter::FromYAML(const YAML::Node &node) {
+    if(node["Name"].as<std::string>() != Name() || !node["MaxWeight"]) return false;
+
+    // Only the maximum weight is needed to unweight events
+    m_percentile.Clear();
+    m_percentile.Add(node["MaxWeight"].as<double>());
+    return true;
+}
+
+bool PercentileUnweighter::AcceptEvent(achilles::Event &event) {
+    return AcceptWeight(event, m_percentile.Get());
+}
+
 std::unique_ptr<achilles::Unweighter> PercentileUnweighter::Construct(const YAML::Node &node) {
     return std::make_unique<PercentileUnweighter>(node);
 }
+
+QuantileUnweighter::QuantileUnweighter(const YAML::Node &node)
+    : m_quantile{node["percentile"].as<double>()/100},
+      m_sketch{node["accuracy"] ? QuantileSketch::FromRankError(node["accuracy"].as<double>())
+                                : QuantileSketch::ForQuantile(m_quantile)} {}
+
+void QuantileUnweighter::AddEvent(const achilles::Event &event) {
+    m_sketch.Add(event.Weight());
+    m_updated = false;
+}
+
+void QuantileUnweighter::AddEvents(const achilles::Unweighter &other) {
+    m_sketch.Merge(dynamic_cast<const QuantileUnweighter&>(other).m_sketch);
+    m_updated = false;
+}
+
+YAML::Node QuantileUnweighter::ToYAML() const {
+    YAML::Node node;
+    node["Name"] = Name();
+    if(m_sketch.Count() > 0 || m_max_wgt > 0) {
+        node["MaxWeight"] = MaxWeight();
+        node["MaxWeightError"] = MaxWeightError();
+    }
+    return node;
+}
+
+bool QuantileUnweighter::FromYAML(const YAML::Node &node) {
+    if(node["Name"].as<std::string>() != Name() || !node["MaxWeight"]) return false;
+
+    // Only the maximum weight is needed to unweight events
+    m_sketch.Clear();
+    m_max_wgt = node["MaxWeight"].as<double>();
+    m_max_wgt_error = node["MaxWeightError"] ? node["MaxWeightError"].as<double>() : 0;
+    m_updated = true;
+    return true;
+}
+
+bool QuantileUnweighter::AcceptEvent(achilles::Event &event) {
+    return AcceptWeight(event, MaxWeight());
+}
+
+double QuantileUnweighter::MaxWeight() const {
+    Update();
+    return m_max_wgt;
+}
+
+double QuantileUnweighter::MaxWeightError() const {
+    Update();
+    return m_max_wgt_error;
+}
+
+void QuantileUnweighter::Update() const {
+    if(m_updated) return;
+
+    // The uncertainty is given by the spread of the weights within the rank error
+    const double error = m_sketch.RankError();
+    m_max_wgt = m_sketch.Quantile(m_quantile);
+    m_max_wgt_error = (m_sketch.Quantile(m_quantile + error) - m_sketch.Quantile(m_quantile - error))/2;
+    m_updated = true;
+}
+
+std::unique_ptr<achilles::Unweighter> QuantileUnweighter::Construct(const YAML::Node &node) {
+    return std::make_unique<QuantileUnweighter>(node);
+}
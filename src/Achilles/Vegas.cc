@@ -22,7 +22,7 @@ void achilles::Vegas::operator()(const Func<double> &func) {
     for(size_t i = 0; i < params.ncalls; ++i) {
         Random::Instance().Generate(rans);
 
-        double wgt = grid(rans);
+        double wgt = GeneratePoint(rans);
         double val = func(rans, wgt);
         double val2 = val * val;
 
@@ -31,9 +31,10 @@ void achilles::Vegas::operator()(const Func<double> &func) {
         for(size_t j = 0; j < grid.Dims(); ++j) {
             train_data[j * grid.Bins() + grid.FindBin(j, rans[j])] += val2; 
         }
+        AddTrainData(rans, val);
     }
 
-    grid.Adapt(params.alpha, train_data);
+    Adapt(train_data);
     summary.results.push_back(results);
     summary.sum_results += results;
 }
@@ -55,11 +56,32 @@ void achilles::Vegas::Optimize(const Func<double> &func) {
     }
 }
 
+double achilles::Vegas::GeneratePoint(std::vector<double> &rans) const {
+    double wgt = strat.Enabled() ? strat(rans) : 1.0;
+    return wgt * grid(rans);
+}
+
 double achilles::Vegas::GenerateWeight(const std::vector<double> &rans) const {
-    return grid.GenerateWeight(rans); 
+    double wgt = grid.GenerateWeight(rans);
+    if(strat.Enabled()) wgt *= strat.GenerateWeight(grid, rans);
+    return wgt;
+}
+
+void achilles::Vegas::AddTrainData(const std::vector<double> &rans, double val) {
+    if(strat.Enabled()) strat.AddTrainData(grid, rans, val);
+}
+
+void achilles::Vegas::MergeTrainData(Vegas &other) {
+    if(strat.Enabled()) strat.MergeTrainData(other.strat);
+}
+
+void achilles::Vegas::ResetTrainData() {
+    if(strat.Enabled()) strat.ResetTrainData();
 }
 
 void achilles::Vegas::Adapt(const std::vector<double> &train_data) {
+    // The hypercubes of the training data are defined by the map before adapting
+    if(strat.Enabled()) strat.Adapt(params.beta);
     grid.Adapt(params.alpha, train_data);
 }
 
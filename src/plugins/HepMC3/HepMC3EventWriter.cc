@@ -1,6 +1,7 @@
 #include "plugins/HepMC3/HepMC3EventWriter.hh"
 #ifdef GZIP
 #include "gzstream/gzstream.h"
+#include "Achilles/BGZFStream.hh"
 #endif
 #include "HepMC3/GenEvent.h"
 #include "HepMC3/GenVertex.h"
@@ -15,14 +16,18 @@
 using achilles::HepMC3Writer;
 using namespace HepMC3;
 
-std::shared_ptr<std::ostream> HepMC3Writer::InitializeStream(const std::string &filename, bool zipped) {
+std::shared_ptr<std::ostream> HepMC3Writer::InitializeStream(const std::string &filename, bool zipped,
+                                                             size_t threads) {
     std::shared_ptr<std::ostream> output = nullptr;
 #ifdef GZIP
     if(zipped) {
         std::string zipname = filename;
         if(filename.substr(filename.size() - 3) != ".gz")
             zipname += std::string(".gz");
-        output = std::make_shared<ogzstream>(zipname.c_str());
+        if(threads > 0)
+            output = std::make_shared<BGZFStream>(zipname, threads);
+        else
+            output = std::make_shared<ogzstream>(zipname.c_str());
     } else
 #endif
         output = std::make_shared<std::ofstream>(filename);
@@ -56,32 +61,28 @@ GenParticlePtr ToHepMC3(const achilles::Particle &particle) {
 
 struct HepMC3Visitor : achilles::HistoryVisitor {
     static constexpr double to_mm = 1e-12;
-    GenEvent evt;
-    struct compare {
-        bool operator()(const achilles::Particle &a, const achilles::Particle &b) const {
-            if(achilles::compare_momentum(a, 1e-10)(b)) {
-                return a.Status() < b.Status();
-            }
-            return a.Momentum().Vec3().Magnitude() < b.Momentum().Vec3().Magnitude();
-        }
-    };
-    std::map<achilles::Particle, GenParticlePtr, HepMC3Visitor::compare> converted;
+    GenEvent &evt;
+    // Particles already added to the event, indexed by their id in the EventHistory
+    std::vector<GenParticlePtr> &converted;
     std::vector<GenParticlePtr> beamparticles;
-    HepMC3Visitor() : evt(Units::MEV, Units::MM), beamparticles(2) {}
+    HepMC3Visitor(GenEvent &_evt, std::vector<GenParticlePtr> &_converted, size_t nparticles)
+            : evt(_evt), converted(_converted), beamparticles(2) {
+        converted.assign(nparticles, nullptr);
+    }
+    GenParticlePtr Convert(const achilles::Particle &part, size_t id) {
+        if(id == achilles::EventHistoryNode::no_id) return ToHepMC3(part);
+        if(id >= converted.size()) converted.resize(id + 1);
+        if(!converted[id]) converted[id] = ToHepMC3(part);
+        return converted[id];
+    }
     void visit(achilles::EventHistoryNode *node) {
         auto position = node -> Position();
         HepMC3::FourVector vertex_pos{position.X(), position.Y(), position.Z(), 0};
         vertex_pos *= to_mm;
         GenVertexPtr vertex = std::make_shared<GenVertex>(vertex_pos);
         vertex->set_status(static_cast<int>(node->Status()));
-        for(const auto &part : node -> ParticlesIn()) {
-            GenParticlePtr particle;
-            if(converted.count(part) > 0) {
-                particle = converted[part];
-            } else {
-                particle = ToHepMC3(part);
-                converted[part] = particle;
-            }
+        for(size_t i = 0; i < node -> ParticlesIn().size(); ++i) {
+            GenParticlePtr particle = Convert(node -> ParticlesIn()[i], node -> IdsIn()[i]);
             if(node -> Status() == achilles::EventHistory::StatusCode::beam) {
                 beamparticles[0] = particle;
             } else if (node -> Status() == achilles::EventHistory::StatusCode::target) {
@@ -89,14 +90,8 @@ struct HepMC3Visitor : achilles::HistoryVisitor {
             }
             vertex -> add_particle_in(particle);
         }
-        for(const auto &part : node -> ParticlesOut()) {
-            GenParticlePtr particle;
-            if(converted.count(part) > 0) {
-                particle = converted[part];
-            } else {
-                particle = ToHepMC3(part);
-                converted[part] = particle;
-            }
+        for(size_t i = 0; i < node -> ParticlesOut().size(); ++i) {
+            GenParticlePtr particle = Convert(node -> ParticlesOut()[i], node -> IdsOut()[i]);
             vertex -> add_particle_out(particle);
         }
         evt.add_vertex(vertex);
@@ -117,21 +112,22 @@ void HepMC3Writer::Write(const achilles::Event &event) {
 
     // Setup event units
     spdlog::trace("Setting up units");
-    HepMC3Visitor visitor;
-    visitor.evt.set_run_info(file.run_info());
-    visitor.evt.set_event_number(results.Calls());
+    // Reuse the event record and its attributes, which only change in value between events
+    m_event.clear();
+    m_event.set_run_info(file.run_info());
+    m_event.set_event_number(results.Calls());
 
     // Interaction type
     // TODO: Add interaction type to the event, and have ids for different modes
-    visitor.evt.add_attribute("InteractionType", std::make_shared<IntAttribute>(1));
+    m_event.add_attribute("InteractionType", m_interaction_type);
 
     // Cross Section
     spdlog::trace("Writing out cross-section");
-    auto cross_section = std::make_shared<GenCrossSection>();
-    cross_section->set_cross_section(results.Mean(), results.Error(), results.FiniteCalls(), results.Calls());
-    visitor.evt.add_attribute("GenCrossSection", cross_section);
-    visitor.evt.add_attribute("Flux", std::make_shared<DoubleAttribute>(event.Flux()));
-    visitor.evt.weight("Default") = event.Weight()*nb_to_pb;
+    m_cross_section->set_cross_section(results.Mean(), results.Error(), results.FiniteCalls(), results.Calls());
+    m_event.add_attribute("GenCrossSection", m_cross_section);
+    m_flux->set_value(event.Flux());
+    m_event.add_attribute("Flux", m_flux);
+    m_event.weight("Default") = event.Weight()*nb_to_pb;
 
     // TODO: once we have a detector to simulate interaction location
     // Event position
@@ -139,7 +135,8 @@ void HepMC3Writer::Write(const achilles::Event &event) {
     // evt.shift_position_to(position);
    
     // Walk the history and add to file
+    HepMC3Visitor visitor(m_event, m_converted, event.History().NParticles());
     event.History().WalkHistory(visitor);
     // visitor.evt.add_tree(visitor.beamparticles);
-    file.write_event(visitor.evt);
+    file.write_event(m_event);
 }
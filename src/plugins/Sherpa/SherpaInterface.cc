@@ -518,22 +518,11 @@ void achilles::SherpaInterface::ToAchilles(ATOOLS::Blob_List *blobs, achilles::E
                 }
             }
             to_update = history.FindNodeOut(visitor.particles[index]);
-            auto compare = compare_momentum(visitor.particles[index]);
-            for(auto &particle : to_update -> ParticlesOut()) {
-                if(compare(particle)) {
-                    particle = decay_part;
-                    break;
-                }
-            }
+            history.ReplaceOutgoing(to_update, visitor.particles[index], decay_part);
         }
 
-        auto compare = compare_momentum(decay_part);
-        for(auto &particle : to_update -> ParticlesOut()) {
-            if(compare(particle)) {
-                particle = decay_part;
-                break;
-            }
-        }
+        // Link the decayed particle to the vertex it leaves
+        history.ReplaceOutgoing(to_update, decay_part, decay_part);
     }
 }
 
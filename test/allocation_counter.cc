@@ -0,0 +1,82 @@
+#include "Achilles/AllocationCounter.hh"
+
+#include <cstdlib>
+#include <new>
+
+// Replacement of the complete set of global allocation functions, counting the allocations
+// made by each thread. Every form allocates with malloc or aligned_alloc, so all of them are
+// released by free
+namespace {
+
+void* Allocate(std::size_t size) noexcept {
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* AllocateAligned(std::size_t size, std::align_val_t align) noexcept {
+    // The size passed to aligned_alloc has to be a multiple of the alignment
+    const auto alignment = static_cast<std::size_t>(align);
+    size = size == 0 ? alignment : (size + alignment - 1) / alignment * alignment;
+    return std::aligned_alloc(alignment, size);
+}
+
+template<typename Alloc>
+void* AllocateOrThrow(Alloc alloc) {
+    achilles::AllocationCounter::Record();
+    while(true) {
+        if(void *ptr = alloc()) return ptr;
+        auto handler = std::get_new_handler();
+        if(!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+template<typename Alloc>
+void* AllocateNoThrow(Alloc alloc) noexcept {
+    try {
+        return AllocateOrThrow(alloc);
+    } catch(...) {
+        return nullptr;
+    }
+}
+
+[[maybe_unused]] const bool registered = (achilles::AllocationCounter::Enable(), true);
+
+}
+
+void* operator new(std::size_t size) {
+    return AllocateOrThrow([size] { return Allocate(size); });
+}
+void* operator new[](std::size_t size) {
+    return AllocateOrThrow([size] { return Allocate(size); });
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return AllocateNoThrow([size] { return Allocate(size); });
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return AllocateNoThrow([size] { return Allocate(size); });
+}
+void* operator new(std::size_t size, std::align_val_t align) {
+    return AllocateOrThrow([size, align] { return AllocateAligned(size, align); });
+}
+void* operator new[](std::size_t size, std::align_val_t align) {
+    return AllocateOrThrow([size, align] { return AllocateAligned(size, align); });
+}
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return AllocateNoThrow([size, align] { return AllocateAligned(size, align); });
+}
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return AllocateNoThrow([size, align] { return AllocateAligned(size, align); });
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
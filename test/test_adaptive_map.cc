@@ -3,6 +3,7 @@
 #include "Achilles/AdaptiveMap.hh"
 
 #include "catch_utils.hh"
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -111,6 +112,78 @@ TEST_CASE("Adaptive Map Histogram Updates", "[vegas]") {
     }
 }
 
+namespace {
+
+// Reference bin lookup, copying the edges of the dimension as done previously
+size_t FindBinCopy(const achilles::AdaptiveMap &map, size_t dim, double x) {
+    const auto edges = map.Edges(dim);
+    auto it = std::lower_bound(edges.begin(), edges.end(), x);
+    return static_cast<size_t>(std::distance(edges.begin(), it))-1;
+}
+
+}
+
+TEST_CASE("Adaptive Map Bin Lookup", "[vegas]") {
+    constexpr size_t ndims = 3;
+    constexpr size_t nbins = 50;
+    achilles::AdaptiveMap map(ndims, nbins);
+    const auto xs = GENERATE(take(1, randomVector(1000)));
+
+    SECTION("Uniform map") {
+        CHECK(map.IsUniform());
+        for(const auto &x : xs)
+            for(size_t i = 0; i < ndims; ++i)
+                CHECK(map.FindBin(i, x) == FindBinCopy(map, i, x));
+        CHECK(map.FindBin(0, 0) == 0);
+        CHECK(map.FindBin(0, 1) == nbins - 1);
+    }
+
+    SECTION("Adapted map") {
+        const auto data = GENERATE(take(1, randomVector(ndims*nbins, 0, 100)));
+        map.Adapt(1.5, data);
+        CHECK_FALSE(map.IsUniform());
+        for(const auto &x : xs)
+            for(size_t i = 0; i < ndims; ++i)
+                CHECK(map.FindBin(i, x) == FindBinCopy(map, i, x));
+        CHECK(map.FindBin(0, 0) == 0);
+        CHECK(map.FindBin(0, 1) == nbins - 1);
+    }
+
+#if defined(CATCH_CONFIG_ENABLE_BENCHMARKING)
+    SECTION("Benchmark") {
+        achilles::AdaptiveMap adapted(ndims, nbins);
+        adapted.Adapt(1.5, GENERATE(take(1, randomVector(ndims*nbins, 0, 100))));
+        BENCHMARK("GenerateWeight (copying edges)") {
+            double jacobian = 1;
+            for(const auto &x : xs)
+                for(size_t i = 0; i < ndims; ++i)
+                    jacobian *= adapted.width(i, FindBinCopy(adapted, i, x))*nbins;
+            return jacobian;
+        };
+
+        BENCHMARK("GenerateWeight (adapted)") {
+            double jacobian = 1;
+            std::vector<double> point(ndims);
+            for(const auto &x : xs) {
+                std::fill(point.begin(), point.end(), x);
+                jacobian *= adapted.GenerateWeight(point);
+            }
+            return jacobian;
+        };
+
+        BENCHMARK("GenerateWeight (uniform)") {
+            double jacobian = 1;
+            std::vector<double> point(ndims);
+            for(const auto &x : xs) {
+                std::fill(point.begin(), point.end(), x);
+                jacobian *= map.GenerateWeight(point);
+            }
+            return jacobian;
+        };
+    }
+#endif
+}
+
 TEST_CASE("Serializing / Deserializing Adaptive Map", "[vegas]") {
     achilles::AdaptiveMap map(4, 4);
 
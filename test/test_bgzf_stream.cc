@@ -0,0 +1,93 @@
+#ifdef GZIP
+#include "catch2/catch.hpp"
+
+#include "Achilles/BGZFStream.hh"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "zlib.h"
+
+namespace {
+
+// Decompress a file made of any number of concatenated gzip members, as gunzip does
+std::string Gunzip(const std::string &data, size_t &nmembers) {
+    z_stream stream{};
+    REQUIRE(inflateInit2(&stream, 15 + 16) == Z_OK);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+
+    std::string result;
+    char buffer[16384];
+    nmembers = 0;
+    while(stream.avail_in > 0) {
+        stream.next_out = reinterpret_cast<Bytef*>(buffer);
+        stream.avail_out = sizeof(buffer);
+        const int status = inflate(&stream, Z_NO_FLUSH);
+        REQUIRE((status == Z_OK || status == Z_STREAM_END));
+        result.append(buffer, sizeof(buffer) - stream.avail_out);
+        if(status == Z_STREAM_END) {
+            nmembers++;
+            inflateReset(&stream);
+        }
+    }
+    inflateEnd(&stream);
+    return result;
+}
+
+std::string ReadFile(const std::string &filename) {
+    std::ifstream input(filename, std::ios::binary);
+    return {std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()};
+}
+
+}
+
+TEST_CASE("BGZF end of file marker", "[BGZFStream]") {
+    // The marker defined in the SAM/BAM specification
+    const std::string expected("\x1f\x8b\x08\x04\x00\x00\x00\x00\x00\xff\x06\x00\x42\x43\x02\x00"
+                               "\x1b\x00\x03\x00\x00\x00\x00\x00\x00\x00\x00\x00", 28);
+    CHECK(achilles::BGZFStreamBuf::eof_marker == expected);
+}
+
+TEST_CASE("BGZF stream output can be decompressed", "[BGZFStream]") {
+    const std::string filename = "test_bgzf_stream.gz";
+    const size_t nthreads = GENERATE(1, 4);
+
+    std::string expected;
+    for(size_t i = 0; i < 50000; ++i)
+        expected += "Event: " + std::to_string(i) + "\n";
+    REQUIRE(expected.size() > 4*achilles::BGZFStreamBuf::block_size);
+
+    {
+        achilles::BGZFStream output(filename, nthreads);
+        REQUIRE(output.good());
+        // Mix small and large writes to cross the block boundaries
+        output << expected.substr(0, 10) << std::flush;
+        output.write(expected.data() + 10, static_cast<std::streamsize>(expected.size() - 10));
+        output.close();
+    }
+
+    const auto data = ReadFile(filename);
+    std::remove(filename.c_str());
+
+    size_t nmembers = 0;
+    CHECK(Gunzip(data, nmembers) == expected);
+    const size_t nblocks = (expected.size() + achilles::BGZFStreamBuf::block_size - 1)
+                           / achilles::BGZFStreamBuf::block_size;
+    CHECK(nmembers == nblocks + 1);
+
+    // Each block records its own size, such that the blocks can be skipped without decompressing
+    size_t pos = 0, nskipped = 0;
+    while(pos < data.size()) {
+        REQUIRE(data.substr(pos + 12, 2) == "BC");
+        pos += (static_cast<unsigned char>(data[pos + 16])
+                | static_cast<size_t>(static_cast<unsigned char>(data[pos + 17])) << 8) + 1;
+        nskipped++;
+    }
+    CHECK(pos == data.size());
+    CHECK(nskipped == nmembers);
+    CHECK(data.substr(data.size() - 28) == achilles::BGZFStreamBuf::eof_marker);
+}
+#endif
@@ -0,0 +1,88 @@
+#include "catch2/catch.hpp"
+
+#include "Achilles/BoundedQueue.hh"
+
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Bounded queue on a single thread", "[BoundedQueue]") {
+    achilles::BoundedQueue<int> queue(5);
+    CHECK(queue.Capacity() == 8);
+
+    SECTION("Elements are returned in order") {
+        for(int i = 0; i < 8; ++i) {
+            int value = i;
+            CHECK(queue.TryPush(value));
+        }
+        int value = 8;
+        CHECK_FALSE(queue.TryPush(value));
+        CHECK(value == 8);
+        CHECK(queue.Size() == 8);
+
+        for(int i = 0; i < 8; ++i) {
+            CHECK(queue.TryPop(value));
+            CHECK(value == i);
+        }
+        CHECK_FALSE(queue.TryPop(value));
+        CHECK(queue.Size() == 0);
+    }
+
+    SECTION("Depth statistics") {
+        for(int i = 0; i < 4; ++i) queue.Push(i);
+        CHECK(queue.Pushed() == 4);
+        CHECK(queue.MaxDepth() == 4);
+        CHECK(queue.MeanDepth() == Approx(2.5));
+    }
+
+    SECTION("Closed queues are drained") {
+        queue.Push(1);
+        queue.Close();
+        CHECK_FALSE(queue.Push(2));
+
+        int value = 0;
+        CHECK(queue.Pop(value));
+        CHECK(value == 1);
+        CHECK_FALSE(queue.Pop(value));
+    }
+}
+
+TEST_CASE("Bounded queue with move-only elements", "[BoundedQueue]") {
+    achilles::BoundedQueue<std::unique_ptr<int>> queue(2);
+    CHECK(queue.Push(std::make_unique<int>(3)));
+
+    std::unique_ptr<int> value;
+    CHECK(queue.Pop(value));
+    REQUIRE(value != nullptr);
+    CHECK(*value == 3);
+}
+
+TEST_CASE("Bounded queue with multiple producers and consumers", "[BoundedQueue]") {
+    static constexpr size_t nthreads = 4, nvalues = 20000;
+    achilles::BoundedQueue<size_t> queue(16);
+
+    std::vector<std::thread> producers, consumers;
+    std::vector<size_t> sums(nthreads), counts(nthreads);
+    for(size_t i = 0; i < nthreads; ++i) {
+        producers.emplace_back([&queue, i]() {
+            for(size_t j = 0; j < nvalues; ++j) queue.Push(i*nvalues + j);
+        });
+        consumers.emplace_back([&queue, &sums, &counts, i]() {
+            size_t value;
+            while(queue.Pop(value)) {
+                sums[i] += value;
+                counts[i]++;
+            }
+        });
+    }
+    for(auto &producer : producers) producer.join();
+    queue.Close();
+    for(auto &consumer : consumers) consumer.join();
+
+    // Every value is received exactly once
+    const size_t total = nthreads*nvalues;
+    CHECK(std::accumulate(counts.begin(), counts.end(), size_t{0}) == total);
+    CHECK(std::accumulate(sums.begin(), sums.end(), size_t{0}) == total*(total - 1)/2);
+    CHECK(queue.MaxDepth() <= queue.Capacity());
+}
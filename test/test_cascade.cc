@@ -8,6 +8,8 @@
 #include "Achilles/Interactions.hh"
 #include "Achilles/Event.hh"
 
+#include <random>
+
 TEST_CASE("Initialize Cascade", "[Cascade]") {
     achilles::Particles particles = {{achilles::PID::proton()}, {achilles::PID::neutron()}};
 
@@ -388,3 +390,37 @@ TEST_CASE("Cascade YAML", "[Cascade]") {
     CHECK(cascade.UsePotentialProp() == false);
     CHECK(cascade.StepSize() == 0.04);
 }
+
+TEST_CASE("Grid and brute force searches agree", "[Cascade]") {
+    // Background nucleons spread over a carbon sized nucleus, with a proton crossing it
+    achilles::Particles particles = {{achilles::PID::proton(), {1000, 300, 200, 600},
+                                      {-0.5, 0.3, -2}, achilles::ParticleStatus::propagating}};
+    std::mt19937 gen(12345);
+    std::uniform_real_distribution<double> dist(-4, 4);
+    for(size_t i = 0; i < 200; ++i) {
+        particles.emplace_back(achilles::PID::neutron(), achilles::FourVector{},
+                               achilles::ThreeVector{dist(gen), dist(gen), dist(gen)},
+                               achilles::ParticleStatus::background);
+    }
+
+    achilles::Cascade cascade(std::make_unique<MockInteraction>(),
+                              achilles::Cascade::ProbabilityType::Gaussian,
+                              achilles::Cascade::InMedium::None, false, 1.0);
+    CHECK(cascade.Search() == achilles::Cascade::SearchMode::BruteForce);
+    const auto brute_force = cascade.InteractionCandidates(particles, 0);
+    REQUIRE(!brute_force.empty());
+
+    SECTION("Grid covering the nucleus finds the same candidates") {
+        cascade.SetSearch(achilles::Cascade::SearchMode::Grid, 20);
+        CHECK(cascade.InteractionCandidates(particles, 0) == brute_force);
+    }
+
+    SECTION("Grid drops only the candidates beyond the search radius") {
+        cascade.SetSearch(achilles::Cascade::SearchMode::Grid);
+        achilles::InteractionDistances expected;
+        const double radius2 = cascade.SearchRadius()*cascade.SearchRadius();
+        std::copy_if(brute_force.begin(), brute_force.end(), std::back_inserter(expected),
+                     [&](const auto &candidate) { return candidate.second <= radius2; });
+        CHECK(cascade.InteractionCandidates(particles, 0) == expected);
+    }
+}
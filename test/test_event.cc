@@ -2,6 +2,7 @@
 #include "mock_classes.hh"
 #include "catch_utils.hh"
 
+#include "Achilles/AllocationCounter.hh"
 #include "Achilles/Beams.hh"
 #include "Achilles/Event.hh"
 #include "Achilles/Nucleus.hh"
@@ -38,7 +39,7 @@ TEST_CASE("Initialize Event Parameters", "[Event]") {
     SECTION("Initialize Particles") {
         REQUIRE_CALL(*nuc, Nucleons())
             .LR_RETURN((particles))
-            .TIMES(5);
+            .TIMES(7);
 
         achilles::Process_Info info;
         info.m_ids = {achilles::PID::electron(), achilles::PID::electron()};
@@ -73,6 +74,20 @@ TEST_CASE("Initialize Event Parameters", "[Event]") {
         CHECK(output[1] == hadrons[1]);
         CHECK(output[2] == leptons[0]);
         CHECK(output[3] == leptons[1]);
+
+        // The views refer to the particles of the event instead of copies
+        auto view = event.ParticlesView();
+        REQUIRE(view.size() == output.size());
+        CHECK(view.ToVector() == output);
+        CHECK(&view[0] == &particles[0]);
+        CHECK(&view[2] == &event.Leptons()[0]);
+
+        auto final = event.FinalParticlesView();
+        REQUIRE(final.size() == 1);
+        CHECK(&*final.begin() == &event.Leptons()[1]);
+
+        auto protons = event.ParticlesView(achilles::PID::proton()).ToVector();
+        CHECK(protons == std::vector<achilles::Particle>{hadrons[0], hadrons[1]});
     }
 
     SECTION("Weight is correct") {
@@ -117,4 +132,86 @@ TEST_CASE("Initialize Event Parameters", "[Event]") {
         CHECK(event.Remnant().PID() == 1000050110);
         CHECK(event.Remnant().Mass() == 11*achilles::Constant::mN);
     }
+
+    SECTION("Event can be reused") {
+        event.Leptons().emplace_back(achilles::PID::electron(), lepton0);
+        event.History().AddVertex({});
+        event.MatrixElementWgts()[0] = 10;
+        event.Weight() = 10;
+
+        REQUIRE_CALL(*nuc, GenerateConfig())
+            .TIMES(1);
+        REQUIRE_CALL(*nuc, NNucleons())
+            .LR_RETURN((12UL))
+            .TIMES(1);
+        const std::vector<achilles::FourVector> moms2 = {hadron1, lepton1, lepton0, hadron0};
+        event.Reset(moms2, 2*vegas_wgt);
+
+        CHECK(event.Momentum() == moms2);
+        CHECK(event.Leptons().empty());
+        CHECK(event.History().size() == 0);
+        CHECK(event.MatrixElementWgts() == std::vector<double>(12));
+        CHECK(event.Weight() == -1);
+    }
+}
+
+#ifdef ACHILLES_COUNT_ALLOCATIONS
+namespace {
+
+// Density with a fixed configuration, filled in place as DensityConfiguration does
+class FixedDensity : public achilles::Density {
+    public:
+        std::vector<achilles::Particle> GetConfiguration() override {
+            std::vector<achilles::Particle> particles;
+            FillConfiguration(particles);
+            return particles;
+        }
+
+        void FillConfiguration(std::vector<achilles::Particle> &particles) override {
+            particles.resize(12);
+            for(size_t i = 0; i < particles.size(); ++i) {
+                const auto pid = i < 6 ? achilles::PID::proton() : achilles::PID::neutron();
+                particles[i] = achilles::Particle(pid, {}, {0, 0, static_cast<double>(i)/6});
+            }
+        }
+};
+
+}
+
+TEST_CASE("Reused events do not allocate", "[Event]") {
+    auto nuc = std::make_shared<achilles::Nucleus>(6, 12, 8.6, 225, "data/c12.prova.txt",
+                                                   achilles::Nucleus::FermiGasType::Global,
+                                                   std::make_unique<FixedDensity>());
+    static constexpr achilles::FourVector lepton0{1000, 0, 0, 1000};
+    static constexpr achilles::FourVector hadron0{65.4247, 26.8702, -30.5306, -10.9449};
+    const std::vector<achilles::FourVector> moms = {hadron0, lepton0};
+    const std::vector<achilles::Particle> incoming = {{achilles::PID::electron(), lepton0}};
+
+    achilles::Event event(nuc);
+    event.Reset(moms, 1);
+    event.Leptons().emplace_back(achilles::PID::electron(), lepton0);
+    event.History().AddVertex({}, incoming);
+
+    const size_t before = achilles::AllocationCounter::Count();
+    event.Reset(moms, 1);
+    event.Leptons().emplace_back(achilles::PID::electron(), lepton0);
+    event.History().AddVertex({}, incoming);
+    CHECK(achilles::AllocationCounter::Count() == before);
+    CHECK(event.CurrentNucleus() -> Nucleons().size() == 12);
+
+    // Copies own their nucleus, and reuse their storage in the same way
+    achilles::Event copy;
+    copy.CopyFrom(event);
+    CHECK(copy.CurrentNucleus() != event.CurrentNucleus());
+    CHECK(copy.CurrentNucleus() -> Nucleons() == event.CurrentNucleus() -> Nucleons());
+
+    event.Reset(moms, 2);
+    event.Leptons().emplace_back(achilles::PID::electron(), lepton0);
+    event.History().AddVertex({}, incoming);
+    const size_t before_copy = achilles::AllocationCounter::Count();
+    copy.CopyFrom(event);
+    CHECK(achilles::AllocationCounter::Count() == before_copy);
+    CHECK(copy.Momentum() == event.Momentum());
+    CHECK(copy.CurrentNucleus() -> Nucleons() == event.CurrentNucleus() -> Nucleons());
 }
+#endif
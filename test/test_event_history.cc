@@ -4,6 +4,7 @@
 #include "Achilles/EventHistory.hh"
 #include "Achilles/Constants.hh"
 #include <string>
+#include <type_traits>
 
 class MockVisitor : public trompeloeil::mock_interface<achilles::HistoryVisitor> {
     IMPLEMENT_MOCK1(visit);
@@ -149,6 +150,89 @@ TEST_CASE("EventHistory", "[EventHistory]") {
         CHECK_THROWS_WITH(history.Target(), "EventHistory: Only one target node is allowed!");
     }
 
+    SECTION("Particle IDs") {
+        // Particles shared between vertices have a single id
+        CHECK(history.NParticles() == 6);
+        CHECK(history.Node(2) -> IdsIn() == std::vector<size_t>{history.Node(0) -> IdsOut()[0],
+                                                                history.Node(1) -> IdsOut()[0]});
+        for(size_t i = 0; i < history.NParticles(); ++i) {
+            auto *node = history.FindNodeIn(history.Particles()[i]);
+            if(!node) node = history.FindNodeOut(history.Particles()[i]);
+            REQUIRE(node != nullptr);
+        }
+
+        // Copies keep the ids
+        achilles::EventHistory copy(history);
+        CHECK(copy.NParticles() == history.NParticles());
+        CHECK(copy.Node(2) -> IdsOut() == history.Node(2) -> IdsOut());
+    }
+
+    SECTION("Particle IDs after inserting a shower vertex") {
+        achilles::Particle neutrino2(achilles::PID::nu_muon(),
+                                    {5.6983343748755351e3, 0, 0, 5.6983343748755351e3});
+        achilles::Particle zd(achilles::PID::Zboson(), neutrino2.Momentum() - neutrino.Momentum());
+        history.InsertShowerVert(neutrino.Position(), neutrino, neutrino, neutrino2, {zd});
+
+        auto *shower = history.Node(3);
+        CHECK(history.Node(1) -> IdsOut()[0] == shower -> IdsIn()[0]);
+        CHECK(history.Node(2) -> IdsIn()[1] == shower -> IdsOut()[0]);
+        CHECK(history.Particles()[shower -> IdsOut()[0]] == neutrino2);
+        CHECK(history.Particles()[shower -> IdsOut()[1]] == zd);
+    }
+
+    SECTION("Reset keeps the vertices for the next event") {
+        auto *primary = history.Primary();
+        history.Reset();
+        CHECK(history.size() == 0);
+        CHECK(history.NParticles() == 0);
+        CHECK(history.Node(0) == nullptr);
+        CHECK(history.FindNodeIn(nuc_in) == nullptr);
+
+        history.AddVertex({}, {target}, {nuc_in}, achilles::EventHistoryNode::StatusCode::target);
+        history.AddVertex({}, {beam}, {neutrino}, achilles::EventHistoryNode::StatusCode::beam);
+        history.AddVertex({}, {nuc_in, neutrino}, {nuc_out, lepton},
+                          achilles::EventHistoryNode::StatusCode::primary);
+        CHECK(history.Primary() == primary);
+        CHECK(history.NParticles() == 6);
+        CHECK(history.Parents(primary).size() == 2);
+        CHECK(primary -> ParticlesOut()[1] == lepton);
+    }
+
+    SECTION("Copied and moved histories own their particles") {
+        achilles::EventHistory moved(std::move(history));
+        REQUIRE(moved.size() == 3);
+        CHECK(moved.Node(2) -> ParticlesIn()[0] == nuc_in);
+
+        achilles::EventHistory copy;
+        copy = moved;
+        moved.Reset();
+        REQUIRE(copy.size() == 3);
+        CHECK(copy.Node(2) -> ParticlesOut()[1] == lepton);
+        CHECK(copy.Children(copy.Node(1)) == std::vector<achilles::EventHistoryNode*>{copy.Node(2)});
+    }
+
+    SECTION("Particles added by index are never merged") {
+        history.Reset();
+        // Two distinct nucleons with the same momentum, e.g. both at rest
+        achilles::Particle nucleon(achilles::PID::proton(), {938, 0, 0, 0});
+        const size_t first = history.AddParticle(nucleon);
+        const size_t second = history.AddParticle(nucleon);
+        const size_t out = history.AddParticle(nuc_out);
+        CHECK(first != second);
+
+        history.AddVertexByIds({}, {first}, {out}, achilles::EventHistoryNode::StatusCode::target);
+        history.AddVertexByIds({}, {second, out}, {}, achilles::EventHistoryNode::StatusCode::primary);
+        CHECK(history.NParticles() == 3);
+        CHECK(history.Node(1) -> IdsIn() == std::vector<size_t>{second, out});
+        CHECK(history.Children(0ul) == std::vector<achilles::EventHistoryNode*>{history.Node(1)});
+        CHECK(history.Parents(1ul) == std::vector<achilles::EventHistoryNode*>{history.Node(0)});
+    }
+
+    SECTION("Moving a history does not throw") {
+        STATIC_REQUIRE(std::is_nothrow_move_constructible_v<achilles::EventHistory>);
+        STATIC_REQUIRE(std::is_nothrow_move_assignable_v<achilles::EventHistory>);
+    }
+
     SECTION("Find node from pointer") {
         CHECK(history.size() == 3);
         auto children0 = history.Children(history.Node(0));
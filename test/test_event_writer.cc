@@ -1,9 +1,19 @@
 #include "catch2/catch.hpp" 
 #include "mock_classes.hh"
 
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
 #include <sstream>
+#include <stdexcept>
+#include <vector>
 
+#include "Achilles/AllocationCounter.hh"
+#include "Achilles/Event.hh"
 #include "Achilles/EventWriter.hh"
+#include "Achilles/HDF5Writer.hh"
 #include "Achilles/Particle.hh"
 #include "Achilles/Version.hh"
 
@@ -37,9 +47,13 @@ TEST_CASE("Builtin", "[EventWriter]") {
         
         const MockEvent event;
         double wgt = 1.0;
-        REQUIRE_CALL(event, Particles())
+        const achilles::Particles leptons;
+        REQUIRE_CALL(event, Hadrons())
             .TIMES(1)
             .LR_RETURN((particles));
+        REQUIRE_CALL(event, Leptons())
+            .TIMES(1)
+            .LR_RETURN((leptons));
         REQUIRE_CALL(event, Remnant())
             .TIMES(1)
             .LR_RETURN((remnant));
@@ -60,3 +74,184 @@ TEST_CASE("Builtin", "[EventWriter]") {
         CHECK(ss.str() == expected);
     }
 }
+
+#if defined(CATCH_CONFIG_ENABLE_BENCHMARKING)
+TEST_CASE("Writer throughput", "[EventWriter][!benchmark]") {
+    static constexpr size_t nevents = 10000;
+    const std::string filename = "test_throughput.txt";
+
+    static constexpr achilles::FourVector hadron{1560.42, -78.4858, -204.738, 1226.89};
+    achilles::Particles particles(10, {achilles::PID::proton(), hadron, {},
+                                       achilles::ParticleStatus::final_state});
+    achilles::NuclearRemnant remnant(11, 5);
+    double wgt = 1.0;
+    const MockEvent event;
+    const achilles::Particles leptons;
+    ALLOW_CALL(event, Hadrons())
+        .LR_RETURN((particles));
+    ALLOW_CALL(event, Leptons())
+        .LR_RETURN((leptons));
+    ALLOW_CALL(event, Remnant())
+        .LR_RETURN((remnant));
+    ALLOW_CALL(event, Weight())
+        .LR_RETURN((wgt));
+
+    auto write_events = [&]() {
+        achilles::AchillesWriter writer(filename, false);
+        for(size_t i = 0; i < nevents; ++i) writer.Write(event);
+        writer.Flush();
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    write_events();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    const auto megabytes = static_cast<double>(file.tellg())/1e6;
+    std::cout << fmt::format("AchillesWriter: {:.0f} events/s, {:.1f} MB/s\n",
+                             static_cast<double>(nevents)/elapsed.count(), megabytes/elapsed.count());
+
+    BENCHMARK("Write 10000 events") {
+        write_events();
+    };
+    std::remove(filename.c_str());
+}
+#endif
+
+TEST_CASE("HDF5", "[EventWriter]") {
+    const std::string filename = "test_events.hdf5";
+    static constexpr size_t nevents = 3;
+
+    static constexpr achilles::FourVector hadron0{65.4247, 26.8702, -30.5306, -10.9449};
+    static constexpr achilles::FourVector hadron1{1560.42, -78.4858, -204.738, 1226.89};
+    achilles::Particles particles = {
+        {achilles::PID::proton(), hadron0, {1, 2, 3}, achilles::ParticleStatus::initial_state},
+        {achilles::PID::neutron(), hadron1, {}, achilles::ParticleStatus::final_state}};
+    achilles::NuclearRemnant remnant(11, 5);
+
+    {
+        // Use a chunk smaller than the number of events to append to the columns
+        achilles::HDF5Writer writer(filename, true, 2);
+        MockEvent event;
+        event.Flux() = 0.5;
+        double wgt = 2.0;
+        // The writer reads the event through the const accessors
+        const MockEvent &const_event = event;
+        const achilles::Particles leptons;
+        REQUIRE_CALL(const_event, Hadrons())
+            .TIMES(nevents)
+            .LR_RETURN((particles));
+        REQUIRE_CALL(const_event, Leptons())
+            .TIMES(nevents)
+            .LR_RETURN((leptons));
+        REQUIRE_CALL(const_event, Remnant())
+            .TIMES(nevents)
+            .LR_RETURN((remnant));
+        REQUIRE_CALL(const_event, Weight())
+            .TIMES(nevents)
+            .LR_RETURN((wgt));
+
+        for(size_t i = 0; i < nevents; ++i) writer.Write(event);
+        writer.AddTrials(1);
+        writer.WriteFooter();
+    }
+
+    HighFive::File file(filename, HighFive::File::ReadOnly);
+    std::vector<double> weight, flux, E, x;
+    std::vector<size_t> offset;
+    std::vector<int> pid, status, remnant_pid;
+    file.getDataSet("events/weight").read(weight);
+    file.getDataSet("events/flux").read(flux);
+    file.getDataSet("events/offset").read(offset);
+    file.getDataSet("events/remnant").read(remnant_pid);
+    file.getDataSet("particles/pid").read(pid);
+    file.getDataSet("particles/status").read(status);
+    file.getDataSet("particles/E").read(E);
+    file.getDataSet("particles/x").read(x);
+    size_t ntrials{};
+    file.getAttribute("trials").read(ntrials);
+    std::remove(filename.c_str());
+
+    CHECK(weight == std::vector<double>(nevents, 2.0));
+    CHECK(flux == std::vector<double>(nevents, 0.5));
+    CHECK(offset == std::vector<size_t>{0, 2, 4});
+    CHECK(remnant_pid == std::vector<int>(nevents, remnant.PID()));
+    CHECK(pid == std::vector<int>{2212, 2112, 2212, 2112, 2212, 2112});
+    CHECK(status == std::vector<int>{3, 1, 3, 1, 3, 1});
+    CHECK(E == std::vector<double>{hadron0.E(), hadron1.E(), hadron0.E(), hadron1.E(),
+                                   hadron0.E(), hadron1.E()});
+    CHECK(x == std::vector<double>{1, 0, 1, 0, 1, 0});
+    CHECK(ntrials == nevents + 1);
+}
+
+// Records the calls made to a writer, and fails on a given event
+class RecordingWriter : public achilles::EventWriter {
+    public:
+        RecordingWriter(std::vector<std::string> &calls, size_t fail_at=0)
+            : m_calls{calls}, m_fail_at{fail_at} {}
+
+        void WriteHeader(const std::string &filename) override { m_calls.push_back("Header " + filename); }
+        void Write(const achilles::Event &event) override {
+            if(++m_nevents == m_fail_at) throw std::runtime_error("Write failed");
+            m_calls.push_back(fmt::format("Event {}", event.Weight()));
+        }
+        void AddTrials(size_t ntrials) override { m_calls.push_back(fmt::format("Trials {}", ntrials)); }
+        void WriteFooter() override { m_calls.push_back("Footer"); }
+
+    private:
+        std::vector<std::string> &m_calls;
+        size_t m_nevents{}, m_fail_at;
+};
+
+TEST_CASE("Asynchronous", "[EventWriter]") {
+    static constexpr size_t nevents = 100;
+    std::vector<std::string> calls;
+
+    SECTION("Calls are passed on in order") {
+        std::vector<std::string> expected{"Header run.yml"};
+        {
+            achilles::AsyncWriter writer(std::make_unique<RecordingWriter>(calls), 4);
+            writer.WriteHeader("run.yml");
+            for(size_t i = 0; i < nevents; ++i) {
+                achilles::Event event;
+                event.Weight() = static_cast<double>(i);
+                writer.AddTrials(i % 3);
+                writer.Write(event);
+                if(i % 3 != 0) expected.push_back(fmt::format("Trials {}", i % 3));
+                expected.push_back(fmt::format("Event {}", static_cast<double>(i)));
+            }
+            writer.WriteFooter();
+            expected.push_back("Footer");
+            writer.Flush();
+            CHECK(calls == expected);
+
+            // Events queued before destruction are still written
+            writer.Write(achilles::Event{});
+        }
+        CHECK(calls.size() == expected.size() + 1);
+    }
+
+    SECTION("Errors are passed to the generation") {
+        achilles::AsyncWriter writer(std::make_unique<RecordingWriter>(calls, 10), 4);
+        auto write_all = [&]() {
+            for(size_t i = 0; i < nevents; ++i) writer.Write(achilles::Event{});
+            writer.Flush();
+        };
+        CHECK_THROWS_WITH(write_all(), "Write failed");
+        CHECK(calls.size() == 9);
+        CHECK_THROWS_WITH(writer.Flush(), "Write failed");
+    }
+
+#ifdef ACHILLES_COUNT_ALLOCATIONS
+    SECTION("Written events are reused") {
+        achilles::AsyncWriter writer(std::make_unique<RecordingWriter>(calls), 4);
+        achilles::Event event;
+        writer.Write(event);
+        writer.Flush();
+
+        const size_t before = achilles::AllocationCounter::Count();
+        writer.Write(event);
+        writer.Flush();
+        CHECK(achilles::AllocationCounter::Count() == before);
+    }
+#endif
+}
@@ -38,6 +38,24 @@ TEST_CASE("Errors 1D", "[Interp]") {
         CHECK_THROWS_WITH(interp(3),
                           fmt::format("Input ({}) greater than maximum value ({})", 3, 2));
     }
+
+    SECTION("Status without exceptions") {
+        const std::vector<double> x = {0, 1, 2}; 
+        const std::vector<double> y = {0, 1, 2};
+
+        achilles::Interp1D interp(x, y);
+        double result = -1;
+        CHECK(interp.TryEvaluate(1, result) == achilles::InterpStatus::NotInitialized);
+        interp.CubicSpline();
+
+        CHECK(interp.TryEvaluate(-1, result) == achilles::InterpStatus::BelowRange);
+        CHECK(interp.TryEvaluate(3, result) == achilles::InterpStatus::AboveRange);
+        CHECK(result == -1);
+        CHECK(interp.TryEvaluate(2, result) == achilles::InterpStatus::Success);
+        CHECK(result == Approx(2));
+        CHECK(interp.TryEvaluate(0.5, result) == achilles::InterpStatus::Success);
+        CHECK(result == Approx(interp(0.5)));
+    }
 }
 
 TEST_CASE("Errors 2D", "[Interp]") {
@@ -74,6 +92,25 @@ TEST_CASE("Errors 2D", "[Interp]") {
         CHECK_THROWS_WITH(interp(0, 3),
                           fmt::format("Input ({}) greater than maximum y value ({})", 3, 2));
     }
+
+    SECTION("Status without exceptions") {
+        const std::vector<double> x = {0, 1, 2}; 
+        const std::vector<double> y = {0, 1, 2};
+        const std::vector<double> z = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+
+        achilles::Interp2D interp(x, y, z);
+        double result = -1;
+        CHECK(interp.TryEvaluate(1, 1, result) == achilles::InterpStatus::NotInitialized);
+        interp.BicubicSpline();
+
+        CHECK(interp.TryEvaluate(-1, 0, result) == achilles::InterpStatus::BelowRange);
+        CHECK(interp.TryEvaluate(3, 0, result) == achilles::InterpStatus::AboveRange);
+        CHECK(interp.TryEvaluate(0, -1, result) == achilles::InterpStatus::BelowRange);
+        CHECK(interp.TryEvaluate(0, 3, result) == achilles::InterpStatus::AboveRange);
+        CHECK(result == -1);
+        CHECK(interp.TryEvaluate(0.5, 1.5, result) == achilles::InterpStatus::Success);
+        CHECK(result == Approx(interp(0.5, 1.5)));
+    }
 }
 
 TEST_CASE("One Dimensional", "[Interp]") {
@@ -229,3 +266,63 @@ TEST_CASE("Two Dimensional", "[Interp]") {
 
     }
 }
+
+// Reference implementation of the bicubic spline by repeated one-dimensional splines
+// (splin2 from Numerical Recipes), which rebuilds a spline in x on every call
+double NestedSpline(const std::vector<double> &x, const std::vector<achilles::Interp1D> &rows,
+                    double xi, double yi) {
+    std::vector<double> zTmp(x.size());
+    for(size_t i = 0; i < x.size(); ++i) zTmp[i] = rows[i](yi);
+    achilles::Interp1D interp(x, zTmp);
+    interp.CubicSpline();
+    return interp(xi);
+}
+
+TEST_CASE("Bicubic Spline Patches", "[Interp]") {
+    auto func = [](double x, double y) { return sin(x)*cos(0.5*y) + 0.1*x*y; };
+    const std::vector<double> xUniform = achilles::Linspace(0, 10, 41);
+    const std::vector<double> xLog = achilles::Logspace(-1, 1, 37);
+    const std::vector<double> y = achilles::Linspace(0, 6, 25);
+    const std::vector<double> x_ = achilles::Linspace(0.1, 9.9, 23);
+    const std::vector<double> y_ = achilles::Linspace(0, 6, 19);
+
+    for(const auto &x : {xUniform, xLog}) {
+        std::vector<double> z;
+        for(const auto &xi : x) 
+            for(const auto &yi : y)
+                z.emplace_back(func(xi, yi));
+        achilles::Interp2D interp(x, y, z, achilles::InterpolationType::CubicSpline);
+        interp.BicubicSpline();
+
+        std::vector<achilles::Interp1D> rows;
+        for(size_t i = 0; i < x.size(); ++i) {
+            rows.emplace_back(y, std::vector<double>(z.begin()+static_cast<int>(i*y.size()),
+                                                     z.begin()+static_cast<int>((i+1)*y.size())));
+            rows.back().CubicSpline();
+        }
+
+        SECTION("Matches nested splines") {
+            for(const auto &xi : x_) {
+                for(const auto &yi : y_) {
+                    CHECK(interp(xi, yi) == Approx(NestedSpline(x, rows, xi, yi)).epsilon(1e-10).margin(1e-12)); 
+                }
+            }
+            CHECK(interp(x.front(), y.front()) == Approx(z.front()));
+            CHECK(interp(x.back(), y.back()) == Approx(z.back()));
+        }
+
+#if defined(CATCH_CONFIG_ENABLE_BENCHMARKING)
+        BENCHMARK("Nested Splines") {
+            double result = 0;
+            for(const auto &xi : x_) result += NestedSpline(x, rows, xi, 3.3);
+            return result;
+        };
+
+        BENCHMARK("Bicubic Patches") {
+            double result = 0;
+            for(const auto &xi : x_) result += interp(xi, 3.3);
+            return result;
+        };
+#endif // CATCH_CONFIG_ENABLE_BENCHMARKING
+    }
+}
@@ -2,6 +2,9 @@
 #include "Achilles/MultiChannel.hh"
 #include "catch_utils.hh"
 
+#include <limits>
+#include <sstream>
+
 constexpr double s0 = -10.0;
 constexpr double s1 = 10.0;
 
@@ -38,6 +41,19 @@ class DoubleMapper : public achilles::Mapper<double> {
         size_t m_channel;
 };
 
+// Integrand of test_func_exp with a channel around each of its peaks
+achilles::Integrand<double> MakeIntegrand(size_t nchannels = 2) {
+    achilles::Integrand<double> integrand(test_func_exp);
+    for(size_t i = 0; i < nchannels; ++i) {
+        achilles::Channel<double> channel;
+        channel.mapping = std::make_unique<DoubleMapper>(i);
+        achilles::AdaptiveMap map(channel.mapping -> NDims(), 50);
+        channel.integrator = achilles::Vegas(map, achilles::VegasParams{});
+        integrand.AddChannel(std::move(channel));
+    }
+    return integrand;
+}
+
 TEST_CASE("YAML encoding / decoding Multichannel Summary", "[multichannel]") {
     achilles::MultiChannelSummary summary;
     constexpr size_t nentries = 2;
@@ -68,6 +84,8 @@ TEST_CASE("YAML encoding / decoding Multichannel Summary", "[multichannel]") {
 
 TEST_CASE("YAML encoding / decoding Multichannel Parameters", "[multichannel]") {
     achilles::MultiChannelParams params{};
+    params.batch_size = 16;
+    params.nstrat = 4;
 
     YAML::Node node;
     node["Params"] = params;
@@ -80,17 +98,12 @@ TEST_CASE("YAML encoding / decoding Multichannel Parameters", "[multichannel]")
     CHECK(params.beta == params2.beta);
     CHECK(params.min_alpha == params2.min_alpha);
     CHECK(params.iteration == params2.iteration);
+    CHECK(params.batch_size == params2.batch_size);
+    CHECK(params.nstrat == params2.nstrat);
 }
 
 TEST_CASE("Multi-Channel Integration", "[multichannel]") {
-    achilles::Integrand<double> integrand(test_func_exp);
-    for(size_t i = 0; i < 2; ++i) {
-        achilles::Channel<double> channel;
-        channel.mapping = std::make_unique<DoubleMapper>(i);
-        achilles::AdaptiveMap map(channel.mapping -> NDims(), 50);
-        channel.integrator = achilles::Vegas(map, achilles::VegasParams{});
-        integrand.AddChannel(std::move(channel));
-    }
+    auto integrand = MakeIntegrand();
 
     SECTION("Runs at least minimum required iterations") {
         static constexpr size_t nitn_min = 10;
@@ -117,17 +130,158 @@ TEST_CASE("Multi-Channel Integration", "[multichannel]") {
         CHECK(std::abs(results.sum_results.Mean() - 1.0) < nsigma*results.sum_results.Error());
         CHECK(results.sum_results.Error()/results.sum_results.Mean() < rtol);
     }
+
+    SECTION("Stratified channels") {
+        static constexpr size_t nitn_min = 10;
+        static constexpr double rtol = 2e-2;
+        achilles::MultiChannelParams params{1000, nitn_min, rtol};
+        params.nstrat = 8;
+        achilles::MultiChannel integrator(1, integrand.NChannels(), params);
+        integrator.Optimize(integrand);
+        auto results = integrator.Summary();
+
+        CHECK(std::abs(results.sum_results.Mean() - 1.0) < nsigma*results.sum_results.Error());
+        for(const auto &channel : integrand.Channels())
+            CHECK(channel.integrator.Strata().Strata() == params.nstrat);
+    }
+
+    SECTION("Batched evaluation") {
+        static constexpr size_t ncalls = 1000, batch_size = 64;
+        achilles::MultiChannelParams params{ncalls, 2, 1};
+        params.batch_size = batch_size;
+
+        achilles::Random::Instance().Seed(123);
+        achilles::MultiChannel integrator(1, integrand.NChannels(), params);
+        integrator(integrand);
+        auto expected = integrator.Summary();
+
+        auto batch_integrand = MakeIntegrand();
+        size_t nbatches = 0;
+        batch_integrand.BatchFunction() = [&](const std::vector<std::vector<double>> &points,
+                                        const std::vector<double> &wgts,
+                                        std::vector<double> &results) {
+            CHECK(points.size() <= batch_size);
+            for(size_t i = 0; i < points.size(); ++i)
+                results[i] = test_func_exp(points[i], wgts[i]);
+            nbatches++;
+        };
+        achilles::Random::Instance().Seed(123);
+        achilles::MultiChannel batched(1, integrand.NChannels(), params);
+        batched(batch_integrand);
+        auto results = batched.Summary();
+
+        CHECK(nbatches == (ncalls + batch_size - 1)/batch_size);
+        CHECK(results.sum_results.Mean() == expected.sum_results.Mean());
+        CHECK(results.sum_results.Error() == expected.sum_results.Error());
+    }
+
+    SECTION("Generating until a stopping condition is met") {
+        static constexpr size_t naccepted = 500;
+        size_t accepted = 0;
+        integrand.Function() = [&](const std::vector<double> &x, double wgt) {
+            const double val = test_func_exp(x, wgt);
+            if(val > 1e-3) accepted++;
+            return val;
+        };
+        achilles::MultiChannelParams params{1000, 1, 1};
+        params.batch_size = GENERATE(as<size_t>{}, 1, 64);
+        achilles::MultiChannel integrator(1, integrand.NChannels(), params);
+        integrator.Generate(integrand, [&]() { return accepted >= naccepted; });
+        auto results = integrator.Summary();
+
+        CHECK(accepted == naccepted);
+        CHECK(results.results.size() == 1);
+        CHECK(results.sum_results.Calls() >= naccepted);
+        CHECK(std::abs(results.sum_results.Mean() - 1.0) < nsigma*results.sum_results.Error());
+    }
+
+    SECTION("Merging iterations from workers") {
+        static constexpr size_t ncalls = 1000;
+        achilles::MultiChannel integrator(1, integrand.NChannels(),
+                                          achilles::MultiChannelParams{ncalls, 1, 1});
+        std::vector<achilles::MultiChannel> workers(2, integrator);
+        for(auto &worker : workers) worker(integrand);
+        integrator.MergeIterations(workers);
+        auto results = integrator.Summary();
+
+        achilles::StatsData expected = workers[0].Summary().results.back();
+        expected += workers[1].Summary().results.back();
+        CHECK(results.results.size() == 1);
+        CHECK(results.sum_results.Calls() == 2*ncalls);
+        CHECK(results.sum_results.Mean() == expected.Mean());
+        CHECK(std::abs(results.sum_results.Mean() - 1.0) < nsigma*results.sum_results.Error());
+    }
+
+    SECTION("Workers sample interleaved events") {
+        static constexpr size_t ncalls = 1000;
+        achilles::MultiChannel integrator(1, integrand.NChannels(),
+                                          achilles::MultiChannelParams{ncalls, 1, 1});
+        integrator(integrand);
+        CHECK(integrator.NextEvent() == ncalls);
+
+        std::vector<achilles::MultiChannel> workers(2, integrator);
+        for(size_t i = 0; i < workers.size(); ++i) {
+            workers[i].SetEvents(integrator.NextEvent() + i, workers.size());
+            size_t ngenerated = 0;
+            workers[i].Generate(integrand, [&ngenerated, i]() { return ngenerated++ >= 10*(i + 1); });
+        }
+        CHECK(workers[0].NextEvent() == ncalls + 2*10);
+        CHECK(workers[1].NextEvent() == ncalls + 1 + 2*20);
+        integrator.MergeIterations(workers);
+        CHECK(integrator.NextEvent() == workers[1].NextEvent());
+    }
 }
 
-TEST_CASE("YAML encoding / decoding Multichannel", "[multichannel]") {
-    achilles::Integrand<double> integrand(test_func_exp);
-    for(size_t i = 0; i < 2; ++i) {
-        achilles::Channel<double> channel;
-        achilles::AdaptiveMap map(1, 50);
-        channel.integrator = achilles::Vegas(map, achilles::VegasParams{});
-        channel.mapping = std::make_unique<DoubleMapper>(i);
-        integrand.AddChannel(std::move(channel));
+TEST_CASE("Multi-Threaded Multi-Channel Integration", "[multichannel]") {
+    static constexpr size_t nitn_min = 4;
+    static constexpr double rtol = 2e-2;
+    auto optimize = [](unsigned int seed, size_t nthreads = 3) {
+        std::vector<achilles::Integrand<double>> integrands;
+        std::vector<achilles::Integrand<double>*> funcs;
+        integrands.reserve(nthreads);
+        for(size_t ithread = 0; ithread < nthreads; ++ithread) {
+            integrands.push_back(MakeIntegrand());
+            funcs.push_back(&integrands.back());
+        }
+
+        achilles::Random::Instance().Seed(seed);
+        achilles::MultiChannel integrator(1, 2, achilles::MultiChannelParams{1000, nitn_min, rtol});
+        integrator.Optimize(funcs);
+        return integrator.Summary();
+    };
+
+    auto results = optimize(12345);
+    CHECK(std::abs(results.sum_results.Mean() - 1.0) < nsigma*results.sum_results.Error());
+    CHECK(results.results.size() >= nitn_min);
+
+    // Results are reproducible for a fixed seed and number of threads
+    auto results2 = optimize(12345);
+    CHECK(results.sum_results.Mean() == results2.sum_results.Mean());
+    CHECK(results.sum_results.Error() == results2.sum_results.Error());
+    CHECK(results.best_weights == results2.best_weights);
+
+    // Counter-based random numbers give the same results for any number of threads, including
+    // the single-threaded optimization
+    achilles::Random::SetDefaultEngine(achilles::Random::Engine::Philox);
+    auto single = optimize(12345, 1);
+    auto multi = optimize(12345, 4);
+    auto integrand = MakeIntegrand();
+    achilles::Random::Instance().Seed(12345);
+    achilles::MultiChannel integrator(1, 2, achilles::MultiChannelParams{1000, nitn_min, rtol});
+    integrator.Optimize(integrand);
+    auto serial = integrator.Summary();
+    achilles::Random::SetDefaultEngine(achilles::Random::Engine::MersenneTwister);
+    CHECK(single.results.size() == multi.results.size());
+    for(const auto &other : {single, serial}) {
+        CHECK(other.sum_results.Calls() == multi.sum_results.Calls());
+        CHECK(other.sum_results.Mean() == multi.sum_results.Mean());
+        CHECK(other.sum_results.Error() == multi.sum_results.Error());
+        CHECK(other.best_weights == multi.best_weights);
     }
+}
+
+TEST_CASE("YAML encoding / decoding Multichannel", "[multichannel]") {
+    auto integrand = MakeIntegrand();
     static constexpr size_t ncalls = 1000, nitn_min = 2;
     static constexpr double rtol = 1;
     achilles::MultiChannel integrator(1, integrand.NChannels(),
@@ -155,4 +309,100 @@ TEST_CASE("YAML encoding / decoding Multichannel", "[multichannel]") {
     CHECK(results1.sum_results.Mean() == results2.sum_results.Mean());
     CHECK(results1.sum_results.Error() == results2.sum_results.Error());
     CHECK(results1.best_weights == results2.best_weights);
+
+    // A restored integrator continues with the next event
+    CHECK(integrator2.NextEvent() == integrator.NextEvent());
+}
+
+TEST_CASE("Restoring trained integrators", "[multichannel]") {
+    auto integrand = MakeIntegrand();
+    achilles::MultiChannelParams params{1000, 2, 1};
+    params.nstrat = 4;
+    achilles::MultiChannel integrator(1, integrand.NChannels(), params);
+    integrator.Optimize(integrand);
+
+    YAML::Node node;
+    node["Channels"] = integrand;
+
+    SECTION("Integrators are restored into the existing channels") {
+        auto integrand2 = MakeIntegrand();
+        REQUIRE(integrand2.LoadIntegrators(node["Channels"]));
+        for(size_t i = 0; i < integrand.NChannels(); ++i) {
+            const auto &vegas1 = integrand.GetChannel(i).integrator;
+            const auto &vegas2 = integrand2.GetChannel(i).integrator;
+            CHECK(vegas1.Grid().Hist() == vegas2.Grid().Hist());
+            CHECK(vegas1.Strata().Probabilities() == vegas2.Strata().Probabilities());
+            CHECK(integrand2.GetChannel(i).mapping != nullptr);
+        }
+    }
+
+    SECTION("Mismatched channels are rejected") {
+        auto integrand2 = MakeIntegrand(1);
+        const auto hist = integrand2.GetChannel(0).integrator.Grid().Hist();
+        CHECK_FALSE(integrand2.LoadIntegrators(node["Channels"]));
+        CHECK(integrand2.GetChannel(0).integrator.Grid().Hist() == hist);
+    }
+}
+
+TEST_CASE("Binary serialization of the integrator state", "[multichannel]") {
+    auto integrand = MakeIntegrand();
+    achilles::MultiChannelParams params{1000, 2, 1};
+    params.nstrat = 4;
+    achilles::MultiChannel integrator(1, integrand.NChannels(), params);
+    integrator.Optimize(integrand);
+    auto results = integrator.Summary();
+
+    std::stringstream ss;
+    achilles::BinaryWriter out(ss);
+    out.Write(integrator);
+    out.Write(integrand);
+    const std::string data = ss.str();
+
+    SECTION("State is restored bit-exact") {
+        achilles::BinaryReader in(data.data(), data.size());
+        achilles::MultiChannel integrator2;
+        REQUIRE(in.Read(integrator2));
+        auto integrand2 = MakeIntegrand();
+        REQUIRE(in.Read(integrand2));
+        CHECK(in.Remaining() == 0);
+
+        auto results2 = integrator2.Summary();
+        CHECK(integrator2.Dimensions() == integrator.Dimensions());
+        CHECK(integrator2.Parameters().ncalls == integrator.Parameters().ncalls);
+        CHECK(integrator2.Parameters().nstrat == params.nstrat);
+        CHECK(results2.best_weights == results.best_weights);
+        CHECK(results2.results.size() == results.results.size());
+        CHECK(results2.sum_results.Mean() == results.sum_results.Mean());
+        CHECK(results2.sum_results.Error() == results.sum_results.Error());
+        CHECK(integrator2.NextEvent() == integrator.NextEvent());
+        for(size_t i = 0; i < integrand.NChannels(); ++i) {
+            const auto &vegas1 = integrand.GetChannel(i).integrator;
+            const auto &vegas2 = integrand2.GetChannel(i).integrator;
+            CHECK(vegas1.Grid().Hist() == vegas2.Grid().Hist());
+            CHECK(vegas1.Grid().IsUniform() == vegas2.Grid().IsUniform());
+            CHECK(vegas1.Strata().Probabilities() == vegas2.Strata().Probabilities());
+        }
+    }
+
+    SECTION("Invalid data is rejected") {
+        CHECK_THROWS_AS(achilles::BinaryReader(data.data(), 4), std::runtime_error);
+
+        std::string corrupt = data;
+        corrupt[0] = 'X';
+        CHECK_THROWS_AS(achilles::BinaryReader(corrupt.data(), corrupt.size()), std::runtime_error);
+
+        achilles::BinaryReader in(data.data(), 64);
+        achilles::MultiChannel integrator2;
+        CHECK_THROWS_AS(in.Read(integrator2), std::runtime_error);
+
+        // A string size overflowing when padded must not pass the bounds check
+        std::stringstream ss_string;
+        achilles::BinaryWriter out_string(ss_string);
+        out_string.Write(std::numeric_limits<size_t>::max() - 2);
+        out_string.Write(std::string(8, 'x'));
+        const std::string string_data = ss_string.str();
+        achilles::BinaryReader in_string(string_data.data(), string_data.size());
+        std::string value;
+        CHECK_THROWS_AS(in_string.Read(value), std::runtime_error);
+    }
 }
@@ -127,6 +127,36 @@ TEST_CASE("Nuclear Configuration", "[Nucleus]") {
     }
 }
 
+TEST_CASE("Cloned nuclei share the density", "[Nucleus]") {
+    const auto fermiGas = achilles::Nucleus::FermiGasType::Global;
+    static constexpr size_t Z = 6;
+    static constexpr double kf = 250;
+
+    achilles::Particles particles;
+    for(size_t i = 0; i < Z; ++i) {
+        particles.emplace_back(achilles::PID::proton());
+        particles.emplace_back(achilles::PID::neutron());
+    }
+
+    // The density is only used once by the constructor, and once for the clone
+    auto density = std::make_unique<MockDensity>();
+    REQUIRE_CALL(*density, GetConfiguration())
+        .TIMES(2)
+        .RETURN(particles);
+
+    achilles::Nucleus nuc(Z, 2*Z, 0, kf, dFile, fermiGas, std::move(density));
+    auto clone = nuc.Clone();
+    CHECK(clone -> NNucleons() == nuc.NNucleons());
+    CHECK(clone -> NProtons() == nuc.NProtons());
+    CHECK(clone -> ID() == nuc.ID());
+    CHECK(clone -> Radius() == nuc.Radius());
+    CHECK(clone -> GetPotential() == nullptr);
+
+    clone -> GenerateConfig();
+    for(size_t i = 0; i < 2*Z; ++i)
+        CHECK(clone -> Nucleons()[i].Momentum().P() < kf);
+}
+
 TEST_CASE("Make Nucleus", "[Nucleus]") {
     const auto fermiGas = achilles::Nucleus::FermiGasType::Local;
 
@@ -0,0 +1,110 @@
+#include "catch2/catch.hpp"
+
+#include "Achilles/Philox.hh"
+#include "Achilles/Random.hh"
+
+#include <cmath>
+#include <thread>
+
+TEST_CASE("Philox4x32 known answers", "[Random]") {
+    using achilles::Philox4x32;
+    // Known answer tests from the Random123 library
+    CHECK(Philox4x32::Block({0, 0, 0, 0}, {0, 0})
+          == Philox4x32::counter_type{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8});
+    CHECK(Philox4x32::Block({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff})
+          == Philox4x32::counter_type{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd});
+    CHECK(Philox4x32::Block({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0})
+          == Philox4x32::counter_type{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1});
+}
+
+TEST_CASE("Philox4x32 event sequences", "[Random]") {
+    achilles::Philox4x32 rng(12345);
+
+    SECTION("Events are reproducible in any order") {
+        rng.SetEvent(7);
+        const auto first = rng();
+        rng.SetEvent(3);
+        rng.discard(13);
+        rng.SetEvent(7);
+        CHECK(rng() == first);
+    }
+
+    SECTION("Events and substreams are distinct") {
+        rng.SetEvent(7);
+        const auto first = rng();
+        rng.SetEvent(8);
+        CHECK(rng() != first);
+        rng.SetEvent(7, 1);
+        CHECK(rng() != first);
+    }
+
+    SECTION("Canonical doubles are in [0, 1)") {
+        std::vector<double> values(1001);
+        rng.GenerateCanonical(values.data(), values.data() + values.size());
+        for(const auto &value : values) {
+            CHECK(value >= 0);
+            CHECK(value < 1);
+        }
+    }
+}
+
+TEST_CASE("Counter-based Random is thread independent", "[Random]") {
+    auto draw = [](size_t event) {
+        auto &rng = achilles::Random::Instance();
+        rng.SetEngine(achilles::Random::Engine::Philox);
+        rng.Seed(42, 0);
+        rng.SetEvent(event);
+        std::vector<double> rans(3);
+        rng.Generate(rans);
+        rans.push_back(rng.Uniform(0.0, 1.0));
+        return rans;
+    };
+
+    std::vector<double> expected = draw(11), result;
+    std::thread worker([&]() { result = draw(11); });
+    worker.join();
+    CHECK(result == expected);
+    achilles::Random::Instance().SetEngine(achilles::Random::Engine::MersenneTwister);
+}
+
+TEST_CASE("AliasTable", "[Random]") {
+    const std::vector<double> weights{1, 0, 3, 4, 2};
+    achilles::AliasTable table(weights);
+    CHECK(table.Size() == weights.size());
+
+    SECTION("Boundary random numbers select valid indices") {
+        CHECK(table(0) < weights.size());
+        CHECK(table(std::nextafter(1.0, 0.0)) < weights.size());
+    }
+
+    SECTION("Samples follow the weights") {
+        static constexpr size_t nsamples = 100000;
+        std::vector<size_t> counts(weights.size());
+        for(size_t i = 0; i < nsamples; ++i)
+            counts[achilles::Random::Instance().SelectIndex(table)]++;
+
+        CHECK(counts[1] == 0);
+        for(size_t i = 0; i < weights.size(); ++i) {
+            const double expected = weights[i]/10*nsamples;
+            CHECK(std::abs(static_cast<double>(counts[i]) - expected) <= 5*std::sqrt(expected) + 1e-8);
+        }
+    }
+
+    SECTION("Invalid weights throw") {
+        CHECK_THROWS_AS(achilles::AliasTable(std::vector<double>{0, 0}), std::runtime_error);
+    }
+}
+
+#if defined(CATCH_CONFIG_ENABLE_BENCHMARKING)
+TEST_CASE("AliasTable benchmark", "[Random]") {
+    std::vector<double> channels(64);
+    for(size_t i = 0; i < channels.size(); ++i) channels[i] = 1.0 + static_cast<double>(i % 7);
+    achilles::AliasTable channel_table(channels);
+    BENCHMARK("Discrete distribution selection") {
+        return achilles::Random::Instance().SelectIndex(channels);
+    };
+    BENCHMARK("Alias table selection") {
+        return achilles::Random::Instance().SelectIndex(channel_table);
+    };
+}
+#endif
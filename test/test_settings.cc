@@ -0,0 +1,68 @@
+#include "catch2/catch.hpp"
+
+#include "Achilles/EventGen.hh"
+#include "Achilles/Settings.hh"
+
+#include <cstdio>
+#include <fstream>
+
+TEST_CASE("Checkpoint hash of the run card", "[Settings]") {
+    std::ofstream card("test_settings.yml");
+    card << R"card(
+Main:
+    NEvents: 100
+    Output:
+        Format: Achilles
+        Name: test.txt
+Process:
+    Final States: [11]
+NuclearModel:
+    Model: QESpectral
+Nucleus: 12C
+Cascade:
+    Run: False
+Initialize:
+    Accuracy: 1e-2
+Options:
+    Unweighting:
+        Name: Percentile
+    Initialize:
+        Stratifications: 4
+)card";
+    card.close();
+
+    achilles::Settings settings("test_settings.yml");
+    const auto &options = achilles::EventGen::CheckpointOptions();
+    const uint64_t hash = settings.Hash(options);
+
+    SECTION("Hash is reproducible") {
+        CHECK(achilles::Settings("test_settings.yml").Hash(options) == hash);
+    }
+
+    SECTION("Changing the accuracy changes the hash") {
+        settings["Initialize"]["Accuracy"] = 1e-3;
+        CHECK(settings.Hash(options) != hash);
+    }
+
+    SECTION("Changing the stratifications changes the hash") {
+        settings["Options"]["Initialize"]["Stratifications"] = 8;
+        CHECK(settings.Hash(options) != hash);
+    }
+
+    SECTION("Changing a file named by an option changes the hash") {
+        std::ofstream("test_settings_params.dat") << "mass 1\n";
+        settings["Process"]["ParamCard"] = "test_settings_params.dat";
+        const uint64_t file_hash = settings.Hash(options);
+        CHECK(file_hash != hash);
+        CHECK(settings.Hash(options) == file_hash);
+
+        std::ofstream("test_settings_params.dat") << "mass 2\n";
+        CHECK(settings.Hash(options) != file_hash);
+        std::remove("test_settings_params.dat");
+    }
+
+    SECTION("Options not used for training keep the hash") {
+        settings["Main"]["NEvents"] = 200;
+        CHECK(settings.Hash(options) == hash);
+    }
+}
@@ -0,0 +1,86 @@
+#include "catch2/catch.hpp"
+
+#include "Achilles/Particle.hh"
+#include "Achilles/SpatialGrid.hh"
+
+#include <algorithm>
+
+namespace {
+
+bool Found(const std::vector<size_t> &result, size_t idx) {
+    return std::find(result.begin(), result.end(), idx) != result.end();
+}
+
+}
+
+TEST_CASE("SpatialGrid", "[Cascade]") {
+    achilles::Particles particles;
+    for(int i = -4; i <= 4; ++i) {
+        particles.emplace_back(achilles::PID::proton(), achilles::FourVector{},
+                               achilles::ThreeVector{static_cast<double>(i), 0, 0},
+                               achilles::ParticleStatus::background);
+    }
+    particles[0].Status() = achilles::ParticleStatus::propagating;
+
+    achilles::SpatialGrid grid(1.0);
+    grid.Build(particles);
+    std::vector<size_t> result;
+
+    SECTION("Only background particles are stored") {
+        CHECK(grid.Size() == particles.size() - 1);
+        CHECK_FALSE(grid.Contains(0));
+        CHECK(grid.Contains(1));
+    }
+
+    SECTION("Query returns nearby particles") {
+        grid.Query({0, 0, 0}, {0, 0, 0.1}, 1.0, result);
+        CHECK(Found(result, 3));
+        CHECK(Found(result, 4));
+        CHECK(Found(result, 5));
+        CHECK_FALSE(Found(result, 0));
+        CHECK_FALSE(Found(result, 1));
+        CHECK_FALSE(Found(result, 8));
+    }
+
+    SECTION("Query is a superset of brute force") {
+        const achilles::ThreeVector start{-0.3, 0.2, 0.1}, end{1.7, -0.4, 0.3};
+        constexpr double radius = 1.5;
+        grid.Query(start, end, radius, result);
+
+        const auto axis = (end - start).Unit();
+        const double length = (end - start).Magnitude();
+        for(size_t i = 1; i < particles.size(); ++i) {
+            const auto diff = particles[i].Position() - start;
+            const double along = diff.Dot(axis);
+            const double perp2 = (diff - along*axis).Magnitude2();
+            if(along >= 0 && along <= length && perp2 <= radius*radius)
+                CHECK(Found(result, i));
+        }
+    }
+
+    SECTION("Remove and update particles") {
+        grid.Remove(4);
+        CHECK_FALSE(grid.Contains(4));
+        CHECK(grid.Size() == particles.size() - 2);
+
+        grid.Update(5, {4, 0, 0});
+        grid.Query({0, 0, 0}, {0, 0, 0.1}, 0.5, result);
+        CHECK_FALSE(Found(result, 5));
+        grid.Query({4, 0, 0}, {4, 0, 0.1}, 0.5, result);
+        CHECK(Found(result, 5));
+        CHECK(Found(result, 8));
+    }
+
+    SECTION("Particles outside the bounds are kept") {
+        grid.Insert(0, {20, 0, 0});
+        grid.Query({4, 0, 0}, {4, 0, 0.1}, 0.5, result);
+        CHECK(Found(result, 0));
+    }
+
+    SECTION("Clear removes all particles") {
+        grid.Clear();
+        CHECK(grid.Size() == 0);
+        grid.Query({0, 0, 0}, {0, 0, 0.1}, 10.0, result);
+        CHECK(result.empty());
+    }
+}
@@ -4,6 +4,9 @@
 
 #include "catch_utils.hh"
 
+#include <algorithm>
+#include <random>
+
 TEST_CASE("Statistics class", "[vegas]") {
     SECTION("Adding individual points together") {
         achilles::StatsData data;
@@ -27,6 +30,24 @@ TEST_CASE("Statistics class", "[vegas]") {
         CHECK(data.Variance() == Approx((mean2 - mean*mean)/static_cast<double>(vals.size()-1)));
     }
 
+    SECTION("Adding zero weight calls at once") {
+        achilles::StatsData data, expected;
+        auto vals = GENERATE(take(10, randomVector(100)));
+        for(const auto &val : vals) {
+            data += val;
+            expected += val;
+        }
+        static constexpr size_t nzeros = 1000;
+        data.AddZeros(nzeros);
+        for(size_t i = 0; i < nzeros; ++i) expected += 0;
+
+        CHECK(data == expected);
+        CHECK(data.Calls() == vals.size() + nzeros);
+        CHECK(data.FiniteCalls() == expected.FiniteCalls());
+        CHECK(data.Min() == expected.Min());
+        CHECK(data.Mean() == expected.Mean());
+    }
+
     SECTION("Adding multiple StatsData together") {
         achilles::StatsData data1, data2;
         auto vals = GENERATE(take(100, randomVector(100)));
@@ -72,3 +93,57 @@ TEST_CASE("YAML encoding / decoding StatsData", "[vegas]") {
     CHECK(data1.Error() == data2.Error());
     CHECK(data1.FiniteCalls() == data2.FiniteCalls());
 }
+
+TEST_CASE("Quantile sketch", "[vegas]") {
+    static constexpr size_t nvalues = 100000;
+    std::mt19937 gen(12345);
+    std::exponential_distribution<double> dist(1.0);
+    std::vector<double> values(nvalues);
+    for(auto &value : values) value = dist(gen);
+
+    auto sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+    auto rank = [&](double x) {
+        const auto it = std::upper_bound(sorted.begin(), sorted.end(), x);
+        return static_cast<double>(it - sorted.begin())/static_cast<double>(nvalues);
+    };
+
+    SECTION("Estimates are within the rank error") {
+        achilles::QuantileSketch sketch;
+        for(const auto &value : values) sketch.Add(value);
+
+        CHECK(sketch.Count() == nvalues);
+        CHECK(sketch.Size() < 10*sketch.K());
+        const double error = sketch.RankError();
+        for(const auto &q : {0.5, 0.9})
+            CHECK(std::abs(rank(sketch.Quantile(q)) - q) <= error);
+    }
+
+    SECTION("Sketches for a quantile resolve its tail") {
+        static constexpr double q = 0.99;
+        auto sketch = achilles::QuantileSketch::ForQuantile(q);
+        for(const auto &value : values) sketch.Add(value);
+
+        CHECK(sketch.RankError() <= (1 - q)/10);
+        CHECK(std::abs(rank(sketch.Quantile(q)) - q) <= (1 - q)/10);
+    }
+
+    SECTION("Merged sketches are within the rank error") {
+        static constexpr size_t nsketches = 4;
+        static constexpr double q = 0.99;
+        std::vector<achilles::QuantileSketch> sketches(nsketches, achilles::QuantileSketch::ForQuantile(q));
+        for(size_t i = 0; i < nvalues; ++i) sketches[i % nsketches].Add(values[i]);
+        achilles::QuantileSketch sketch = sketches[0];
+        for(size_t i = 1; i < nsketches; ++i) sketch.Merge(sketches[i]);
+
+        CHECK(sketch.Count() == nvalues);
+        CHECK(sketch.Size() < 10*sketch.K());
+        CHECK(std::abs(rank(sketch.Quantile(q)) - q) <= (1 - q)/10);
+    }
+
+    SECTION("Accuracy sets the size of the sketch") {
+        auto sketch = achilles::QuantileSketch::FromRankError(0.01);
+        CHECK(sketch.RankError() <= 0.01);
+        CHECK(achilles::QuantileSketch::FromRankError(0.001).K() > sketch.K());
+    }
+}
@@ -18,6 +18,14 @@ double test_func2(const std::vector<double> &x, double wgt) {
 
 }
 
+// Narrow ridge along the diagonal, which can not be captured by a separable grid
+double test_ridge(const std::vector<double> &x, double wgt) {
+    constexpr double width = 0.05;
+    const double norm = std::sqrt(2*std::acos(-1.0))*width*std::erf(1/(std::sqrt(2.0)*width));
+    const double diff = (x[0] - x[1])/width;
+    return std::exp(-diff*diff/2)/(norm - 2*width*width*(1 - std::exp(-1/(2*width*width))))*wgt;
+}
+
 TEST_CASE("YAML encoding / decoding vegas summary", "[vegas]") {
     achilles::VegasSummary summary;
     constexpr size_t nentries = 3;
@@ -86,3 +94,117 @@ TEST_CASE("YAML encoding / decoding Vegas", "[vegas]") {
     CHECK(results1.sum_results.Mean() == results2.sum_results.Mean());
     CHECK(results1.sum_results.Error() == results2.sum_results.Error());
 }
+
+TEST_CASE("Stratified sampling", "[vegas]") {
+    static constexpr size_t ndims = 2, nstrat = 4;
+    achilles::AdaptiveMap map(ndims, 10);
+    for(size_t i = 0; i < map.Hist().size(); ++i) {
+        // Non-uniform map to test the inversion of the grid
+        const double x = map.Hist()[i];
+        map.Hist()[i] = x*x;
+    }
+    achilles::Stratification strat(ndims, nstrat);
+
+    SECTION("Hypercubes are limited") {
+        achilles::Stratification large(10, 10);
+        CHECK(large.NCubes() <= achilles::Stratification::max_cubes);
+        CHECK(large.Strata() == 3);
+        CHECK_FALSE(achilles::Stratification(ndims, 1).Enabled());
+    }
+
+    SECTION("Weights are consistent") {
+        std::vector<double> probs(strat.NCubes());
+        for(size_t i = 0; i < probs.size(); ++i) probs[i] = static_cast<double>(i + 1);
+        double sum = 0;
+        for(const auto &prob : probs) sum += prob;
+        for(auto &prob : probs) prob /= sum;
+        strat.SetProbabilities(probs);
+
+        static constexpr size_t npoints = 100000;
+        std::vector<double> rans(ndims);
+        achilles::StatsData volume;
+        for(size_t i = 0; i < npoints; ++i) {
+            achilles::Random::Instance().Generate(rans);
+            double wgt = strat(rans);
+            wgt *= map(rans);
+            CHECK_THAT(strat.GenerateWeight(map, rans)*map.GenerateWeight(rans),
+                       Catch::Matchers::WithinRel(wgt, 1e-10));
+            volume += wgt;
+        }
+        CHECK(std::abs(volume.Mean() - 1.0) < nsigma*volume.Error());
+    }
+
+    SECTION("Training data can be merged") {
+        achilles::Stratification other = strat;
+        std::vector<double> rans(ndims);
+        for(size_t i = 0; i < 1000; ++i) {
+            achilles::Random::Instance().Generate(rans);
+            double wgt = strat(rans)*map(rans);
+            other.AddTrainData(map, rans, test_ridge(rans, wgt));
+        }
+        strat.MergeTrainData(other);
+        other.Adapt(0.75);
+        strat.Adapt(0.75);
+        CHECK(other.Probabilities() == achilles::Stratification(ndims, nstrat).Probabilities());
+        CHECK(strat.Probabilities() != other.Probabilities());
+    }
+
+    SECTION("Training data can be discarded") {
+        std::vector<double> rans(ndims);
+        for(size_t i = 0; i < 1000; ++i) {
+            achilles::Random::Instance().Generate(rans);
+            double wgt = strat(rans)*map(rans);
+            strat.AddTrainData(map, rans, test_ridge(rans, wgt));
+        }
+        strat.ResetTrainData();
+        strat.Adapt(0.75);
+        CHECK(strat.Probabilities() == achilles::Stratification(ndims, nstrat).Probabilities());
+    }
+
+    SECTION("YAML encoding / decoding") {
+        std::vector<double> rans(ndims);
+        for(size_t i = 0; i < 1000; ++i) {
+            achilles::Random::Instance().Generate(rans);
+            double wgt = strat(rans)*map(rans);
+            strat.AddTrainData(map, rans, test_ridge(rans, wgt));
+        }
+        strat.Adapt(0.75);
+
+        YAML::Node node;
+        node["Stratification"] = strat;
+        auto strat2 = node["Stratification"].as<achilles::Stratification>();
+        CHECK(strat2.Strata() == strat.Strata());
+        CHECK(strat2.Probabilities() == strat.Probabilities());
+    }
+}
+
+TEST_CASE("Vegas Stratified Integration", "[vegas]") {
+    static constexpr size_t nitn = 10, ncalls = 10000;
+    static constexpr double rtol = 0, atol = 0;
+    achilles::Vegas vegas(achilles::AdaptiveMap(2, 50),
+                          achilles::VegasParams{ncalls, 100, rtol, atol, 1.5, nitn});
+    achilles::Vegas stratified(achilles::AdaptiveMap(2, 50),
+                               achilles::VegasParams{ncalls, 100, rtol, atol, 1.5, nitn, 16});
+    vegas.SetVerbosity(0);
+    stratified.SetVerbosity(0);
+    for(size_t i = 0; i < nitn; ++i) {
+        vegas(test_ridge);
+        stratified(test_ridge);
+    }
+    auto results = vegas.Summary().results.back();
+    auto results_strat = stratified.Summary().results.back();
+
+    CHECK(std::abs(results_strat.Mean() - 1.0) < nsigma*results_strat.Error());
+    CHECK(results_strat.Error() < results.Error()/2);
+
+    SECTION("YAML encoding / decoding") {
+        YAML::Node node;
+        node["Vegas"] = stratified;
+        auto stratified2 = node["Vegas"].as<achilles::Vegas>();
+        CHECK(stratified2.Strata().Probabilities() == stratified.Strata().Probabilities());
+
+        node["Vegas"] = vegas;
+        CHECK_FALSE(node["Vegas"]["Stratification"]);
+        CHECK_FALSE(node["Vegas"].as<achilles::Vegas>().Strata().Enabled());
+    }
+}